@@ -21,14 +21,22 @@ Item {
         id: dataManager
     }
     
-    // 商品模型
-    ListModel {
-        id: productModel
-    }
+    // 商品模型：C++ 列表模型，只保存命中商品的下标，滚动到哪里才读取到哪里
+    property var productModel: dataManager.productModel
     
     // 筛选和搜索相关属性
     property string currentSearchText: ""
     property string currentCategory: "全部"
+    property bool inStockOnly: false
+    
+    // 分面计数（由商品模型随查询结果一起给出）
+    property var categoryCounts: productModel.categoryCounts
+    property int totalCount: sumCounts(categoryCounts)
+    property int inStockCount: productModel.inStockCount
+    
+    // 输入补全相关属性
+    property var suggestions: []
+    property bool suppressSuggestions: false
     
     // 渐变背景
     Rectangle {
@@ -147,14 +155,37 @@ Item {
                                 background: Item {}
                                 verticalAlignment: TextInput.AlignVCenter
                                 
+                                // 模型对关键词自带防抖，并在后台线程查询，输入时不会卡住界面
                                 onTextChanged: {
                                     currentSearchText = text
-                                    searchTimer.restart()
+                                    updateSuggestions()
+                                    productModel.keyword = text
+                                }
+                                
+                                onActiveFocusChanged: {
+                                    if (!activeFocus) {
+                                        suggestionPopup.close()
+                                    }
                                 }
                                 
                                 Keys.onPressed: {
-                                    if (event.key === Qt.Key_Return || event.key === Qt.Key_Enter) {
-                                        applyFilters()
+                                    if (event.key === Qt.Key_Down && suggestionPopup.visible) {
+                                        suggestionList.incrementCurrentIndex()
+                                        event.accepted = true
+                                    } else if (event.key === Qt.Key_Up && suggestionPopup.visible) {
+                                        suggestionList.decrementCurrentIndex()
+                                        event.accepted = true
+                                    } else if (event.key === Qt.Key_Escape && suggestionPopup.visible) {
+                                        suggestionPopup.close()
+                                        event.accepted = true
+                                    } else if (event.key === Qt.Key_Return || event.key === Qt.Key_Enter) {
+                                        if (suggestionPopup.visible && suggestionList.currentIndex >= 0) {
+                                            selectSuggestion(suggestions[suggestionList.currentIndex].text)
+                                        } else {
+                                            suggestionPopup.close()
+                                            applyFilters()
+                                            productModel.queryNow()
+                                        }
                                         event.accepted = true
                                     }
                                 }
@@ -188,12 +219,70 @@ Item {
                             }
                         }
                         
-                        // 搜索延迟定时器
-                        Timer {
-                            id: searchTimer
-                            interval: 500
-                            repeat: false
-                            onTriggered: applyFilters()
+                        // 输入补全下拉列表
+                        Popup {
+                            id: suggestionPopup
+                            y: parent.height + 4
+                            width: parent.width
+                            height: Math.min(suggestionList.contentHeight, 8 * 36) + 8
+                            padding: 4
+                            closePolicy: Popup.CloseOnPressOutside
+                            
+                            background: Rectangle {
+                                radius: 10
+                                color: "#ffffff"
+                                border.color: "#ecf0f1"
+                                border.width: 1
+                            }
+                            
+                            ListView {
+                                id: suggestionList
+                                anchors.fill: parent
+                                clip: true
+                                model: suggestions
+                                currentIndex: -1
+                                
+                                delegate: Rectangle {
+                                    width: suggestionList.width
+                                    height: 36
+                                    radius: 6
+                                    color: (suggestionArea.containsMouse || ListView.isCurrentItem) ? "#ecf5fd" : "transparent"
+                                    
+                                    RowLayout {
+                                        anchors.fill: parent
+                                        anchors.leftMargin: 10
+                                        anchors.rightMargin: 10
+                                        spacing: 8
+                                        
+                                        Text {
+                                            text: modelData.isCategory ? getCategoryIcon(modelData.text) : "🔍"
+                                            font.pixelSize: 13
+                                        }
+                                        
+                                        Text {
+                                            Layout.fillWidth: true
+                                            text: modelData.text
+                                            font.pixelSize: 13
+                                            color: "#2c3e50"
+                                            elide: Text.ElideRight
+                                        }
+                                        
+                                        Text {
+                                            text: modelData.isCategory ? "分类 · " + modelData.productCount : (modelData.productCount > 1 ? modelData.productCount + " 件" : "")
+                                            font.pixelSize: 11
+                                            color: "#95a5a6"
+                                        }
+                                    }
+                                    
+                                    MouseArea {
+                                        id: suggestionArea
+                                        anchors.fill: parent
+                                        hoverEnabled: true
+                                        cursorShape: Qt.PointingHandCursor
+                                        onClicked: selectSuggestion(modelData.text)
+                                    }
+                                }
+                            }
                         }
                     }
                 }
@@ -324,6 +413,14 @@ Item {
                                             horizontalAlignment: Text.AlignLeft // 文本左对齐
                                             verticalAlignment: Text.AlignVCenter    // 文本垂直居中
                                         }
+                                        
+                                        // 该分类下满足其余条件的商品数
+                                        Text {
+                                            text: modelData.text === "全部" ? totalCount : (categoryCounts[modelData.text] || 0)
+                                            font.pixelSize: 13
+                                            color: categoryBtn.checked ? "white" : "#95a5a6"
+                                            Layout.alignment: Qt.AlignVCenter
+                                        }
                                     }
                                     
                                     onCheckedChanged: {
@@ -343,6 +440,20 @@ Item {
                             }
                         }
                         
+                        // 库存筛选
+                        CheckBox {
+                            id: inStockCheck
+                            Layout.fillWidth: true
+                            text: "仅看有货 (" + inStockCount + ")"
+                            checked: inStockOnly
+                            font.pixelSize: 14
+                            
+                            onToggled: {
+                                inStockOnly = checked
+                                applyFilters()
+                            }
+                        }
+                        
                         Item { Layout.fillHeight: true }
                     }
                 }
@@ -374,12 +485,33 @@ Item {
                             }
                             
                             Text {
-                                text: "共找到 " + productModel.count + " 件商品"
+                                text: "共找到 " + productModel.totalCount + " 件商品" + (productModel.busy ? " · 搜索中…" : "")
                                 font.pixelSize: 13
                                 color: "#7f8c8d"
                             }
                             
                             Item { Layout.fillWidth: true }
+                            
+                            // 排序：由商品模型按有序索引排列，"默认"为相关度（有关键词时）或原顺序
+                            ComboBox {
+                                id: sortBox
+                                Layout.preferredWidth: 150
+                                font.pixelSize: 13
+                                textRole: "text"
+                                model: [
+                                    { text: "默认排序", key: "", descending: false },
+                                    { text: "价格从低到高", key: "price", descending: false },
+                                    { text: "价格从高到低", key: "price", descending: true },
+                                    { text: "评分最高", key: "avgRating", descending: true },
+                                    { text: "评价最多", key: "reviewers", descending: true }
+                                ]
+                                
+                                onActivated: function(index) {
+                                    var option = model[index]
+                                    productModel.descending = option.descending
+                                    productModel.sortKey = option.key
+                                }
+                            }
                         }
                         
                         // 商品网格
@@ -666,7 +798,7 @@ Item {
                         ColumnLayout {
                             Layout.alignment: Qt.AlignCenter
                             spacing: 15
-                            visible: productModel.count === 0
+                            visible: productModel.totalCount === 0
                             
                             Text {
                                 Layout.alignment: Qt.AlignHCenter
@@ -739,57 +871,51 @@ Item {
     }
     
     function hasActiveFilters() {
-        return currentSearchText !== "" || currentCategory !== "全部"
+        return currentSearchText !== "" || currentCategory !== "全部" || inStockOnly
+    }
+    
+    // 输入补全：前缀树查询很快，每次输入都直接刷新，不经过搜索延迟定时器
+    function updateSuggestions() {
+        if (suppressSuggestions || !searchField.activeFocus || currentSearchText.trim() === "") {
+            suggestions = []
+            suggestionPopup.close()
+            return
+        }
+        
+        suggestions = dataManager.getCompletions(currentSearchText, 8)
+        suggestionList.currentIndex = -1
+        if (suggestions.length > 0) {
+            suggestionPopup.open()
+        } else {
+            suggestionPopup.close()
+        }
+    }
+    
+    function selectSuggestion(text) {
+        suppressSuggestions = true
+        searchField.text = text
+        suppressSuggestions = false
+        
+        suggestions = []
+        suggestionPopup.close()
+        applyFilters()
+        productModel.queryNow()
+    }
+    
+    function sumCounts(counts) {
+        var sum = 0
+        for (var name in counts) {
+            sum += counts[name]
+        }
+        return sum
     }
     
     // 数据操作函数
+    // 筛选条件写入模型属性，模型在 C++ 中一次求交集并刷新分面计数；未变化的条件不会触发查询
     function applyFilters() {
-        try {
-            productModel.clear()
-            
-            var filteredProducts = []
-            
-            if (currentSearchText === "" && currentCategory === "全部") {
-                filteredProducts = dataManager.getProducts()
-            } else if (currentSearchText !== "" && currentCategory === "全部") {
-                filteredProducts = dataManager.searchProducts(currentSearchText)
-            } else if (currentSearchText === "" && currentCategory !== "全部") {
-                filteredProducts = dataManager.filterByCategory(currentCategory)
-            } else {
-                var searchResults = dataManager.searchProducts(currentSearchText)
-                var categoryResults = dataManager.filterByCategory(currentCategory)
-                
-                var searchMap = {}
-                for (var i = 0; i < searchResults.length; i++) {
-                    var product = searchResults[i]
-                    searchMap[product.productId] = product
-                }
-                
-                for (var j = 0; j < categoryResults.length; j++) {
-                    var catProduct = categoryResults[j]
-                    if (searchMap[catProduct.productId]) {
-                        filteredProducts.push(catProduct)
-                    }
-                }
-            }
-            
-            for (var k = 0; k < filteredProducts.length; k++) {
-                var finalProduct = filteredProducts[k]
-                productModel.append({
-                    "productId": finalProduct.productId,
-                    "name": finalProduct.name,
-                    "price": finalProduct.price,
-                    "stock": finalProduct.stock,
-                    "category": finalProduct.category,
-                    "avgRating": finalProduct.avgRating,
-                    "reviewers": finalProduct.reviewers
-                })
-            }
-            
-        } catch (error) {
-            console.error("应用筛选条件时发生错误:", error)
-            loadAllProducts()
-        }
+        productModel.keyword = currentSearchText
+        productModel.category = currentCategory
+        productModel.inStockOnly = inStockOnly
     }
     
     function resetFilters() {
@@ -803,34 +929,21 @@ Item {
             }
         }
         currentCategory = "全部"
+        inStockOnly = false
         
         loadAllProducts()
     }
     
     function loadAllProducts() {
         try {
-            productModel.clear()
-            
+            // 重新加载后模型会按当前条件重新查询
             var loadSuccess = dataManager.loadProductsFromJson()
             if (!loadSuccess) {
                 console.error("从JSON文件加载商品数据失败")
                 return false
             }
             
-            var products = dataManager.getProducts()
-            
-            for (var i = 0; i < products.length; i++) {
-                var product = products[i]
-                productModel.append({
-                    "productId": product.productId,
-                    "name": product.name,
-                    "price": product.price,
-                    "stock": product.stock,
-                    "category": product.category,
-                    "avgRating": product.avgRating,
-                    "reviewers": product.reviewers
-                })
-            }
+            applyFilters()
             
             return true
             
@@ -958,7 +958,7 @@ Item {
                 if (currentUser) {
                     var added = dataManager.addViewHistory(currentUser, productId)
                     if (added) {
-                        var saved = dataManager.saveUsersToJson()
+                        var saved = dataManager.saveDirtyUsers()
                         console.log("浏览历史记录", added ? "成功" : "失败", ", 保存到文件", saved ? "成功" : "失败")
                     } else {
                         console.warn("添加浏览历史失败，可能用户或商品不存在")
@@ -21,6 +21,10 @@ Item {
     
     // 添加刷新锁定机制，防止重复刷新
     property bool isRefreshing: false
+
+    // 用户列表分页加载：先取第一页，滚动到底部时再取下一页
+    property int pageSize: 50
+    property int totalUserCount: 0
     
     // UserManager 实例
     UserManager {
@@ -67,7 +71,8 @@ Item {
     property var userStats: ({
         "totalUsers": 0,
         "adminUsers": 0,
-        "regularUsers": 0
+        "regularUsers": 0,
+        "activeUsers": 0
     })
     
     // 组件完成时加载数据
@@ -92,27 +97,11 @@ Item {
         userModel.clear()
         
         try {
-            var users = userManager.getAllUsers()
-            console.log("获取到用户数据:", users.length, "个用户")
-            
-            for (var i = 0; i < users.length; i++) {
-                var user = users[i]
-                
-                // 添加默认注册日期如果不存在
-                var registerDate = user.registerDate || "未知"
-                
-                userModel.append({
-                    "userId": user.userId,
-                    "username": user.username,
-                    "userType": user.userType,
-                    "isAdmin": user.isAdmin,
-                    "cartItemCount": user.cartItemCount || 0,
-                    "browseCount": user.browseCount || 0,
-                    "registerDate": registerDate
-                })
-            }
-            
-            console.log("用户列表刷新完成，共", userModel.count, "个用户")
+            totalUserCount = userManager.getUserCount()
+            appendUserPage()
+            console.log("用户列表刷新完成，已加载", userModel.count, "/", totalUserCount, "个用户")
+            // 统计由 C++ 增量维护，读取开销为常数，随列表一起刷新
+            refreshUserStats()
         } catch (error) {
             console.error("刷新用户列表时出错:", error)
             showMessage("刷新用户列表失败: " + error, true)
@@ -121,6 +110,37 @@ Item {
         }
     }
     
+    // 追加下一页用户
+    function appendUserPage() {
+        var users = userManager.getUsers(userModel.count, pageSize)
+        for (var i = 0; i < users.length; i++) {
+            var user = users[i]
+
+            // 添加默认注册日期如果不存在
+            var registerDate = user.registerDate || "未知"
+
+            userModel.append({
+                "userId": user.userId,
+                "username": user.username,
+                "userType": user.userType,
+                "isAdmin": user.isAdmin,
+                "cartItemCount": user.cartItemCount || 0,
+                "browseCount": user.browseCount || 0,
+                "registerDate": registerDate
+            })
+        }
+    }
+
+    function loadMoreUsers() {
+        if (isRefreshing || userModel.count >= totalUserCount) return
+        isRefreshing = true
+        try {
+            appendUserPage()
+        } finally {
+            isRefreshing = false
+        }
+    }
+
     // 刷新用户统计
     function refreshUserStats() {
         try {
@@ -147,13 +167,8 @@ Item {
     }
     
     function getUserData(userId) {
-        var users = userManager.getAllUsers()
-        for (var i = 0; i < users.length; i++) {
-            if (users[i].userId === userId) {
-                return users[i]
-            }
-        }
-        return null
+        var user = userManager.getUserById(userId)
+        return user.userId !== undefined ? user : null
     }
     
     function validateUserData(userData) {
@@ -606,7 +621,7 @@ Item {
                                     }
                                     
                                     Text {
-                                        text: "总计: " + userStats.totalUsers + " 人 (管理员: " + userStats.adminUsers + ", 普通用户: " + userStats.regularUsers + ")"
+                                        text: "总计: " + userStats.totalUsers + " 人 (管理员: " + userStats.adminUsers + ", 普通用户: " + userStats.regularUsers + ") · 活跃 " + userStats.activeUsers + " 人"
                                         font.pixelSize: 12
                                         color: "#7f8c8d"
                                     }
@@ -806,6 +821,12 @@ Item {
                                 id: userListView
                                 model: userModel
                                 spacing: 12
+
+                                onAtYEndChanged: {
+                                    if (atYEnd) {
+                                        loadMoreUsers()
+                                    }
+                                }
                                 
                                 delegate: Rectangle {
                                     width: userListView.width
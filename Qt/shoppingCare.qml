@@ -12,30 +12,24 @@ Item {
 
     property var stateManager: null
     property string currentUserName: ""
-    property real totalPrice: 0
-    property int totalQuantity: 0
-    property string totalPriceText: "\u00A50.00"
+    // 购物车模型：增删改直接在 C++ 中完成，总价与总数量随修改增量更新
+    property var cartModel: dataManager.cartModel
+    property real totalPrice: cartModel.totalPrice
+    property int totalQuantity: cartModel.totalQuantity
+    property string totalPriceText: formatPrice(totalPrice)
 
     DataManager {
         id: dataManager
     }
 
-    ListModel {
-        id: cartModel
-    }
-
     function refreshCart() {
         console.log("开始刷新购物车数据...")
         
         // 检查 StateManager 是否注入
         if (!cartPage.stateManager) {
             console.log("StateManager 未注入，无法加载购物车")
-            // 尝试清空数据显示
-            cartModel.clear()
-            cartPage.totalPrice = 0
-            cartPage.totalQuantity = 0
-            cartPage.totalPriceText = cartPage.formatPrice(0)
             cartPage.currentUserName = ""
+            cartModel.load("")
             return
         }
 
@@ -45,73 +39,23 @@ Item {
         
         if (!cartPage.currentUserName || cartPage.currentUserName.length === 0) {
             console.log("用户未登录，清空购物车显示")
-            cartModel.clear()
-            cartPage.totalPrice = 0
-            cartPage.totalQuantity = 0
-            cartPage.totalPriceText = cartPage.formatPrice(0)
-            return
         }
 
-        // 调用 DataManager 获取购物车详情
-        var result = dataManager.getShoppingCartDetails(cartPage.currentUserName)
-        console.log("购物车数据获取结果:", JSON.stringify(result))
-        
-        cartModel.clear()
-
-        if (result && result.items && result.items.length > 0) {
-            console.log("找到购物车商品:", result.items.length, "个")
-            
-            for (var i = 0; i < result.items.length; ++i) {
-                var item = result.items[i] || {}
-                console.log("添加商品:", item.name, "数量:", item.quantity, "单价:", item.unitPrice)
-                
-                cartModel.append({
-                    productId: item.productId || 0,  // 添加商品ID，用于操作
-                    name: item.name || "未知商品",
-                    quantity: item.quantity || 0,
-                    unitPrice: item.unitPrice || 0,
-                    subtotal: item.subtotal || 0,
-                    displayUnitPrice: cartPage.formatPrice(item.unitPrice || 0),
-                    displaySubtotal: cartPage.formatPrice(item.subtotal || 0)
-                })
-            }
-            
-            cartPage.totalPrice = result.totalPrice || 0
-            cartPage.totalQuantity = result.totalQuantity || 0
-            cartPage.totalPriceText = cartPage.formatPrice(cartPage.totalPrice)
-            
-            console.log("购物车总计: 商品数量", cartPage.totalQuantity, "总价", cartPage.totalPrice)
-        } else {
-            console.log("购物车为空或无有效数据")
-            cartPage.totalPrice = 0
-            cartPage.totalQuantity = 0
-            cartPage.totalPriceText = cartPage.formatPrice(0)
-        }
+        cartModel.load(cartPage.currentUserName || "")
+        console.log("购物车总计: 商品种类", cartModel.count, "商品数量", cartModel.totalQuantity, "总价", cartModel.totalPrice)
     }
 
     function formatPrice(value) {
         return "\u00A5" + Number(value || 0).toFixed(2)
     }
 
-    // 新增：修改商品数量
+    // 新增：修改商品数量（数量为0或负数时删除商品）
     function updateQuantity(productId, newQuantity) {
-        if (!cartPage.stateManager) {
-            console.log("StateManager 未注入，无法修改数量")
-            return false
-        }
-        
         console.log("修改商品数量，ID:", productId, "新数量:", newQuantity)
         
-        if (newQuantity <= 0) {
-            // 数量为0或负数时删除商品
-            return removeItem(productId)
-        }
-        
-        var success = cartPage.stateManager.updateCartQuantity(productId, newQuantity)
+        var success = cartModel.setQuantity(productId, newQuantity)
         if (success) {
             console.log("商品数量修改成功")
-            // 刷新购物车显示
-            refreshCart()
             return true
         } else {
             console.log("商品数量修改失败")
@@ -121,18 +65,11 @@ Item {
 
     // 新增：删除商品
     function removeItem(productId) {
-        if (!cartPage.stateManager) {
-            console.log("StateManager 未注入，无法删除商品")
-            return false
-        }
-        
         console.log("删除购物车商品，ID:", productId)
         
-        var success = cartPage.stateManager.removeFromCart(productId)
+        var success = cartModel.remove(productId)
         if (success) {
             console.log("商品删除成功")
-            // 刷新购物车显示
-            refreshCart()
             return true
         } else {
             console.log("商品删除失败")
@@ -140,6 +77,31 @@ Item {
         }
     }
 
+    // 结算：库存不足时购物车保持不变，提示缺货商品的剩余库存
+    property string checkoutMessage: ""
+
+    // 结算在后台等待保存完成，结果由 cartModel.checkoutFinished 通知
+    function checkout() {
+        if (cartModel.checkout()) {
+            checkoutMessage = "正在结算..."
+        }
+    }
+
+    Connections {
+        target: cartPage.cartModel
+
+        function onCheckoutFinished(outcome) {
+            console.log("结算结果:", outcome.success, outcome.message)
+            if (outcome.success) {
+                cartPage.checkoutMessage = "结算成功，共 " + outcome.totalQuantity + " 件，" + cartPage.formatPrice(outcome.totalPrice)
+            } else if (outcome.failedProductId >= 0 && outcome.message.indexOf("库存不足") === 0) {
+                cartPage.checkoutMessage = outcome.message + "（剩余 " + outcome.availableStock + " 件）"
+            } else {
+                cartPage.checkoutMessage = "结算失败: " + outcome.message
+            }
+        }
+    }
+
     // 监听状态管理器的状态变化
     Connections {
         target: cartPage.stateManager
@@ -637,6 +599,13 @@ Item {
                             color: "#2c3e50"
                             horizontalAlignment: Text.AlignLeft
                         }
+                        Text {
+                            text: cartPage.checkoutMessage
+                            visible: text.length > 0
+                            font.pixelSize: 13
+                            color: "#e67e22"
+                            horizontalAlignment: Text.AlignLeft
+                        }
                     }
 
                     Item {
@@ -662,6 +631,38 @@ Item {
                         }
                     }
 
+                    // 结算按钮
+                    Rectangle {
+                        Layout.preferredWidth: 120
+                        Layout.preferredHeight: 45
+                        radius: 10
+                        color: checkoutArea.containsMouse ? "#27ae60" : "#2ecc71"
+                        visible: cartModel.count > 0
+
+                        scale: checkoutArea.pressed ? 0.98 : 1.0
+
+                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on scale { NumberAnimation { duration: 100 } }
+
+                        Text {
+                            anchors.centerIn: parent
+                            text: "去结算"
+                            color: "white"
+                            font.pixelSize: 13
+                            font.bold: true
+                        }
+
+                        MouseArea {
+                            id: checkoutArea
+                            anchors.fill: parent
+                            hoverEnabled: true
+                            cursorShape: Qt.PointingHandCursor
+
+                            enabled: !cartModel.checkingOut
+                            onClicked: cartPage.checkout()
+                        }
+                    }
+
                     // 新增：清空购物车按钮
                     Rectangle {
                         Layout.preferredWidth: 120
@@ -861,23 +862,12 @@ Item {
 
     // 清空所有商品的函数
     function clearAllItems() {
-        if (!cartPage.stateManager || cartModel.count === 0) {
+        if (cartModel.count === 0) {
             return
         }
 
         console.log("开始清空购物车，共", cartModel.count, "个商品")
-
-        // 逐个删除所有商品
-        for (var i = 0; i < cartModel.count; i++) {
-            var item = cartModel.get(i)
-            if (item && item.productId) {
-                cartPage.stateManager.removeFromCart(item.productId)
-            }
-        }
-
-        // 刷新购物车显示
-        refreshCart()
-        
+        cartModel.clear()
         console.log("购物车清空完成")
     }
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+/**
+ * @brief 结算并发压力测试
+ *
+ * 多个线程在同一个 DataManager 上同时为不同用户结算，另有线程不断修改购物车中的数量，检查：
+ * - 任何商品的库存都不会变为负数（不超卖）
+ * - 每个商品的初始库存 = 剩余库存 + 各次成功结算售出的数量
+ * - 落盘后重新加载得到的库存与内存一致
+ *
+ * 用法：checkout_stress [线程数] [每线程结算次数]
+ * 数据文件写在可执行文件上级的 bin 目录（构建目录下），不影响项目数据
+ */
+#include "DataManager.h"
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int kProductCount = 16;
+    constexpr int kInitialStock = 200;
+    constexpr int kUsersPerThread = 8;
+
+    std::string userName(int thread, int index) {
+        return "stress_" + std::to_string(thread) + "_" + std::to_string(index);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false"));
+
+    const int threadCount = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int roundsPerThread = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    DataManager manager;
+    std::vector<ProductData> products;
+    for (int i = 0; i < kProductCount; i++) {
+        ProductData product{};
+        product.productId = 1000 + i;
+        product.name = PooledString("压力测试商品" + std::to_string(i));
+        product.category = PooledString("压力测试");
+        product.price = 10.0 + i;
+        product.stock = kInitialStock;
+        products.push_back(product);
+    }
+    manager.getProducts() = products;
+
+    std::vector<UserData> users;
+    for (int t = 0; t < threadCount; t++) {
+        for (int i = 0; i < kUsersPerThread; i++) {
+            UserData user{};
+            user.userId = t * kUsersPerThread + i + 1;
+            user.username = userName(t, i);
+            users.push_back(std::move(user));
+        }
+    }
+    manager.replaceUsers(std::move(users));
+    manager.saveProductsToJson();
+    manager.saveUsersToJson();
+    if (!manager.flush()) {
+        std::printf("初始数据保存失败\n");
+        return 1;
+    }
+
+    std::vector<std::atomic<int> > sold(kProductCount);
+    std::atomic<int> succeeded{0};
+    std::atomic<int> outOfStock{0};
+    std::atomic<bool> done{false};
+
+    // 每个结算线程只操作自己的用户：加购若干商品后结算
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(static_cast<unsigned>(t) * 7919u + 1u);
+            for (int round = 0; round < roundsPerThread; round++) {
+                const std::string username = userName(t, round % kUsersPerThread);
+                const int lines = 1 + static_cast<int>(rng() % 3);
+                for (int i = 0; i < lines; i++) {
+                    manager.addToCart(username, 1000 + static_cast<int>(rng() % kProductCount),
+                                      1 + static_cast<int>(rng() % 4));
+                }
+
+                CheckoutResult result;
+                if (manager.checkout(username, result)) {
+                    succeeded++;
+                    for (const CartItemDetails &item : result.items) {
+                        sold[item.productId - 1000] += item.quantity;
+                    }
+                } else if (result.failedProductId >= 0) {
+                    outOfStock++;
+                    manager.removeFromCart(username, result.failedProductId);
+                }
+            }
+        });
+    }
+
+    // 干扰线程：在结算进行时修改各用户购物车中的数量
+    std::thread meddler([&]() {
+        std::mt19937 rng(42);
+        while (!done.load()) {
+            const std::string username = userName(static_cast<int>(rng() % threadCount),
+                                                  static_cast<int>(rng() % kUsersPerThread));
+            manager.updateCartQuantity(username, 1000 + static_cast<int>(rng() % kProductCount),
+                                       static_cast<int>(rng() % 3));
+        }
+    });
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    done = true;
+    meddler.join();
+
+    int violations = 0;
+    for (int i = 0; i < kProductCount; i++) {
+        const ProductData *product = manager.findProduct(1000 + i);
+        if (product->stock < 0 || product->stock + sold[i].load() != kInitialStock) {
+            std::printf("商品 %d：剩余库存 %d，售出 %d，初始 %d\n", product->productId, product->stock,
+                        sold[i].load(), kInitialStock);
+            violations++;
+        }
+    }
+
+    if (!manager.flush()) {
+        std::printf("落盘失败\n");
+        violations++;
+    }
+    DataManager reloaded;
+    for (int i = 0; i < kProductCount; i++) {
+        const ProductData *saved = reloaded.findProduct(1000 + i);
+        const ProductData *live = manager.findProduct(1000 + i);
+        if (saved == nullptr || saved->stock != live->stock) {
+            std::printf("商品 %d：文件中的库存与内存不一致\n", 1000 + i);
+            violations++;
+        }
+    }
+
+    std::printf("线程 %d，结算成功 %d 次，库存不足 %d 次，违规 %d 处\n", threadCount, succeeded.load(),
+                outOfStock.load(), violations);
+    return violations == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * @brief FlatHashMap 与 std::unordered_map 的对比测试
+ *
+ * 分别以整数键（商品ID，等间隔）和字符串键（用户名）测量：
+ * - 插入 n 个键（不预留空间）
+ * - 随机查找已有的键、查找不存在的键
+ * - 删除一半的键
+ * 另在 n 个元素的数组上测量 std::find_if 线性查找，作为建立索引前 findUser / findProduct 的对照
+ *
+ * 用法：flat_hash_map_bench [元素个数...]，默认 100000 1000000
+ * 输出为每次操作的平均耗时（纳秒）
+ */
+#include "FlatHashMap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr size_t kProbeCount = 1000000;
+    constexpr size_t kLinearProbeCount = 1000; // 线性查找太慢，只测少量
+
+    using Clock = std::chrono::steady_clock;
+
+    double nanosPerOp(Clock::time_point start, size_t ops) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(ops);
+    }
+
+    // 防止查找结果被优化掉
+    volatile size_t g_sink;
+
+    // 两种哈希表的统一接口
+    template <typename K>
+    struct FlatAdapter {
+        FlatHashMap<K, size_t> map;
+        void insert(const K &key, size_t value) { map.insert(key, value); }
+        const size_t *find(const K &key) const { return map.find(key); }
+        void erase(const K &key) { map.erase(key); }
+    };
+
+    template <typename K>
+    struct StdAdapter {
+        std::unordered_map<K, size_t> map;
+        void insert(const K &key, size_t value) { map.emplace(key, value); }
+        const size_t *find(const K &key) const {
+            auto it = map.find(key);
+            return it != map.end() ? &it->second : nullptr;
+        }
+        void erase(const K &key) { map.erase(key); }
+    };
+
+    struct Result {
+        double insert;
+        double hit;
+        double miss;
+        double erase;
+    };
+
+    template <typename Map, typename K>
+    Result measure(const std::vector<K> &keys, const std::vector<K> &hits, const std::vector<K> &misses) {
+        Result result{};
+        Map map;
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < keys.size(); i++) {
+            map.insert(keys[i], i);
+        }
+        result.insert = nanosPerOp(start, keys.size());
+
+        size_t found = 0;
+        start = Clock::now();
+        for (const K &key : hits) {
+            const size_t *value = map.find(key);
+            found += value != nullptr ? *value : 0;
+        }
+        result.hit = nanosPerOp(start, hits.size());
+
+        start = Clock::now();
+        for (const K &key : misses) {
+            found += map.find(key) != nullptr;
+        }
+        result.miss = nanosPerOp(start, misses.size());
+
+        start = Clock::now();
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            map.erase(keys[i]);
+        }
+        result.erase = nanosPerOp(start, (keys.size() + 1) / 2);
+
+        g_sink = found;
+        return result;
+    }
+
+    template <typename K>
+    double measureLinear(const std::vector<K> &keys, const std::vector<K> &hits) {
+        size_t found = 0;
+        const size_t probes = std::min(kLinearProbeCount, hits.size());
+        auto start = Clock::now();
+        for (size_t i = 0; i < probes; i++) {
+            auto it = std::find_if(keys.begin(), keys.end(), [&](const K &key) { return key == hits[i]; });
+            found += static_cast<size_t>(it - keys.begin());
+        }
+        g_sink = found;
+        return nanosPerOp(start, probes);
+    }
+
+    void print(const char *label, size_t n, const char *name, const Result &result) {
+        std::printf("%s n=%zu %-13s 插入 %6.1f  命中 %6.1f  未命中 %6.1f  删除 %6.1f\n", label, n, name,
+                    result.insert, result.hit, result.miss, result.erase);
+    }
+
+    template <typename K>
+    void run(const char *label, const std::vector<K> &keys, const std::vector<K> &missKeys, std::mt19937 &rng) {
+        std::vector<K> hits(kProbeCount);
+        std::vector<K> misses(kProbeCount);
+        for (size_t i = 0; i < kProbeCount; i++) {
+            hits[i] = keys[rng() % keys.size()];
+            misses[i] = missKeys[rng() % missKeys.size()];
+        }
+
+        const Result flat = measure<FlatAdapter<K> >(keys, hits, misses);
+        const Result standard = measure<StdAdapter<K> >(keys, hits, misses);
+        const double linear = measureLinear(keys, hits);
+
+        print(label, keys.size(), "FlatHashMap", flat);
+        print(label, keys.size(), "unordered_map", standard);
+        std::printf("%s n=%zu %-13s 查找 %.0f\n", label, keys.size(), "线性查找", linear);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(static_cast<size_t>(std::strtoull(argv[i], nullptr, 10)));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000};
+    }
+
+    std::printf("单位：纳秒/次\n");
+    for (size_t n : sizes) {
+        std::mt19937 rng(static_cast<unsigned>(n));
+
+        // 商品ID：等间隔，插入顺序打乱
+        std::vector<int> ids(n);
+        std::vector<int> missingIds(n);
+        for (size_t i = 0; i < n; i++) {
+            ids[i] = static_cast<int>(1000 + i * 4);
+            missingIds[i] = ids[i] + 1;
+        }
+        std::shuffle(ids.begin(), ids.end(), rng);
+        run("商品ID", ids, missingIds, rng);
+
+        // 用户名
+        std::vector<std::string> names(n);
+        std::vector<std::string> missingNames(n);
+        for (size_t i = 0; i < n; i++) {
+            names[i] = "user" + std::to_string(i);
+            missingNames[i] = "guest" + std::to_string(i);
+        }
+        std::shuffle(names.begin(), names.end(), rng);
+        run("用户名", names, missingNames, rng);
+    }
+    return 0;
+}
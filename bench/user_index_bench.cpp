@@ -0,0 +1,144 @@
+/**
+ * @brief 用户索引两种后端（持久化红黑树 UserRBTree 与 B+ 树 UserBTree）的对比测试
+ *
+ * 两棵树共用同一批用户记录（只保存记录指针），对每种规模分别测量：
+ * - 随机顺序逐个插入；批量建立一半后按ID升序追加另一半（addUser 的情形）
+ * - 随机查找：只定位，以及定位后读取记录
+ * - 范围扫描：从随机位置按名次定位后顺序读取 1000 个（分页），以及完整遍历
+ *
+ * 用法：user_index_bench [用户数...]，默认 100000 1000000；10000000 个用户约需 3 GB 内存
+ * 输出中插入与查找为每次操作的平均耗时（纳秒），扫描为总耗时（毫秒）
+ */
+#include "DataManager.h"
+#include "UserBTree.h"
+#include "UserRBTree.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr size_t kProbeCount = 2000000;
+    constexpr size_t kPageCount = 2000;
+    constexpr int kPageSize = 1000;
+
+    using Clock = std::chrono::steady_clock;
+    using Record = std::shared_ptr<const UserData>;
+
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 防止查找结果被优化掉
+    volatile long long g_sink;
+
+    struct Workload {
+        std::vector<Record> sorted;   // 按用户ID升序
+        std::vector<Record> shuffled; // 同一批记录，随机顺序
+        std::vector<int> probes;      // 随机查找的用户ID（都存在）
+        std::vector<size_t> pages;    // 分页的起始名次
+    };
+
+    Workload makeWorkload(size_t n) {
+        Workload workload;
+        workload.sorted.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            auto user = std::make_shared<UserData>();
+            user->userId = static_cast<int>(i * 3); // 留出空隙，插入位置不全在末尾
+            user->username = "user" + std::to_string(i);
+            workload.sorted.push_back(std::move(user));
+        }
+        std::mt19937 rng(static_cast<unsigned>(n));
+        workload.shuffled = workload.sorted;
+        std::shuffle(workload.shuffled.begin(), workload.shuffled.end(), rng);
+        workload.probes.resize(kProbeCount);
+        for (int &probe : workload.probes) {
+            probe = static_cast<int>(rng() % n) * 3;
+        }
+        workload.pages.resize(kPageCount);
+        for (size_t &page : workload.pages) {
+            page = rng() % n;
+        }
+        return workload;
+    }
+
+    template <typename Tree>
+    void measure(const char *label, const Workload &workload) {
+        const size_t n = workload.sorted.size();
+        long long sum = 0;
+        Tree tree;
+
+        auto start = Clock::now();
+        for (const Record &record : workload.shuffled) {
+            tree.insert(record);
+        }
+        const double randomInsert = elapsedMs(start) * 1e6 / static_cast<double>(n);
+
+        start = Clock::now();
+        for (int userId : workload.probes) {
+            sum += tree.find(userId) != nullptr;
+        }
+        const double lookup = elapsedMs(start) * 1e6 / static_cast<double>(kProbeCount);
+
+        start = Clock::now();
+        for (int userId : workload.probes) {
+            sum += (*tree.find(userId))->userId;
+        }
+        const double lookupRead = elapsedMs(start) * 1e6 / static_cast<double>(kProbeCount);
+
+        start = Clock::now();
+        for (size_t page : workload.pages) {
+            int read = 0;
+            for (auto cursor = tree.select(page); cursor != typename Tree::Cursor() && read < kPageSize;
+                 cursor.next(), read++) {
+                sum += cursor.record()->userId;
+            }
+        }
+        const double pages = elapsedMs(start);
+
+        start = Clock::now();
+        for (auto cursor = tree.begin(); cursor != typename Tree::Cursor(); cursor.next()) {
+            sum += cursor.record()->userId;
+        }
+        const double fullScan = elapsedMs(start);
+
+        // 批量建立前一半，再按升序追加后一半
+        tree.clear();
+        const size_t half = n / 2;
+        tree.build(std::vector<Record>(workload.sorted.begin(), workload.sorted.begin() + static_cast<long>(half)));
+        start = Clock::now();
+        for (size_t i = half; i < n; i++) {
+            tree.insert(workload.sorted[i]);
+        }
+        const double append = elapsedMs(start) * 1e6 / static_cast<double>(n - half);
+        if (tree.size() != n) {
+            std::printf("%s：追加后键数 %zu 与预期 %zu 不符\n", label, tree.size(), n);
+        }
+
+        g_sink = sum;
+        std::printf("%-9zu %-7s %10.0f %8.0f %8.0f %10.0f %14.1f %12.1f\n", n, label, randomInsert, append, lookup,
+                    lookupRead, pages, fullScan);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(static_cast<size_t>(std::strtoull(argv[i], nullptr, 10)));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000};
+    }
+
+    std::printf("用户数    后端     随机插入     追加     查找  查找+读取  %zu 页x%d(ms)  完整遍历(ms)\n", kPageCount,
+                kPageSize);
+    for (size_t n : sizes) {
+        const Workload workload = makeWorkload(n);
+        measure<UserRBTree>("红黑树", workload);
+        measure<UserBTree>("B+ 树", workload);
+    }
+    return 0;
+}
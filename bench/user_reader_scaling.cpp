@@ -0,0 +1,135 @@
+/**
+ * @brief UserManager 读者扩展性测试
+ *
+ * 读线程不断按用户ID（getUserById）和用户名（getUserByName，登录时的查找）随机查找，
+ * 依次用 1、2、4…个读线程，每组运行固定时长，统计总吞吐量；
+ * 每组再在同时有一个写线程不断添加、删除用户的情况下运行一次。
+ * 红黑树与 B+ 树两种索引后端分别测量
+ *
+ * 用法：user_reader_scaling [用户数] [最大读线程数] [每组时长（毫秒）]
+ * 默认 100000 个用户，读线程数最多到 CPU 核数，每组 1000 毫秒。
+ * 数据文件写在可执行文件上级的 bin 目录（构建目录下），不影响项目数据
+ */
+#include "UserManager.h"
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Throughput {
+        double readsPerSecond;
+        double writesPerSecond;
+    };
+
+    Throughput measure(UserManager &manager, const std::vector<QString> &names, int readers, bool withWriter,
+                       int durationMs) {
+        const int userCount = static_cast<int>(names.size());
+        std::atomic<bool> stop{false};
+        std::atomic<long long> reads{0};
+        std::atomic<long long> writes{0};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < readers; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 rng(static_cast<unsigned>(t) + 1u);
+                long long done = 0;
+                long long found = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const int index = static_cast<int>(rng() % static_cast<unsigned>(userCount));
+                    const QVariantMap user = (done & 1) ? manager.getUserByName(names[index])
+                                                        : manager.getUserById(index + 1);
+                    found += user.isEmpty() ? 0 : 1;
+                    done++;
+                }
+                reads += done;
+                if (found == 0) {
+                    std::printf("读线程 %d 没有找到任何用户\n", t);
+                }
+            });
+        }
+        if (withWriter) {
+            threads.emplace_back([&]() {
+                long long done = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const QString name = QStringLiteral("scaling_writer_%1").arg(done);
+                    if (manager.addUser(name, QStringLiteral("password"))) {
+                        manager.deleteUser(manager.getUserByName(name)["userId"].toInt());
+                    }
+                    done++;
+                }
+                writes += done;
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+        stop = true;
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {static_cast<double>(reads.load()) / seconds, static_cast<double>(writes.load()) / seconds};
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false"));
+
+    const int userCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int maxReaders = argc > 2 ? std::atoi(argv[2])
+                                    : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int durationMs = argc > 3 ? std::atoi(argv[3]) : 1000;
+
+    // 准备用户文件，UserManager 构造时从中加载；用户ID为 1..userCount
+    std::vector<QString> names;
+    {
+        DataManager data;
+        std::vector<UserData> users;
+        users.reserve(static_cast<size_t>(userCount));
+        for (int i = 0; i < userCount; i++) {
+            UserData user{};
+            user.userId = i + 1;
+            user.username = "scaling_" + std::to_string(i + 1);
+            names.push_back(QString::fromStdString(user.username));
+            users.push_back(std::move(user));
+        }
+        data.replaceUsers(std::move(users));
+        data.saveUsersToJson();
+        if (!data.flush()) {
+            std::printf("用户数据保存失败\n");
+            return 1;
+        }
+    }
+
+    std::printf("%d 个用户，每组 %d 毫秒；读吞吐量单位：万次/秒\n", userCount, durationMs);
+    for (UserIndexBackend backend : {UserIndexBackend::RedBlackTree, UserIndexBackend::BPlusTree}) {
+        UserManager manager(backend);
+        if (manager.getUserCount() != userCount) {
+            std::printf("加载的用户数 %d 与预期 %d 不符\n", manager.getUserCount(), userCount);
+            return 1;
+        }
+        const char *label = backend == UserIndexBackend::BPlusTree ? "B+ 树" : "红黑树";
+
+        double single = 0;
+        for (int readers = 1; readers <= maxReaders; readers *= 2) {
+            const Throughput alone = measure(manager, names, readers, false, durationMs);
+            const Throughput mixed = measure(manager, names, readers, true, durationMs);
+            if (readers == 1) {
+                single = alone.readsPerSecond;
+            }
+            std::printf("%s 读线程 %2d：无写者 %8.1f（%.2f 倍）  有写者 %8.1f（写 %.0f 次/秒）\n", label, readers,
+                        alone.readsPerSecond / 1e4, alone.readsPerSecond / single, mixed.readsPerSecond / 1e4,
+                        mixed.writesPerSecond);
+        }
+    }
+    return 0;
+}
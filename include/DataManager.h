@@ -12,6 +12,22 @@
 #include <nlohmann/json.hpp>
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include "PersistenceWorker.h"
+#include "FlatHashMap.h"
+#include "InteractionList.h"
+#include "StringPool.h"
+#include "ProductSearchIndex.h"
+#include "ProductAutocomplete.h"
+#include "ProductFacetIndex.h"
+#include "ProductSortedIndex.h"
+#include "StockLedger.h"
 
 using json = nlohmann::ordered_json;
 
@@ -22,25 +38,132 @@ struct UserData {
     std::string username;
     std::string password;
     std::string salt;
-    std::vector<std::vector<int> > shoppingCart; // 购物车，二维数组 [[商品ID, 数量], ...]
-    std::vector<std::vector<int> > viewHistory; // 浏览历史，二维数组 [[商品ID, 浏览次数], ...]
-    std::vector<std::vector<int> > favorites; // 收藏/评分，二维数组 [[商品ID, 评分值], ...]
+    InteractionList shoppingCart; // 购物车，{商品ID, 数量}，按商品ID升序
+    InteractionList viewHistory; // 浏览历史，{商品ID, 浏览次数}
+    InteractionList favorites; // 收藏/评分，{商品ID, 评分值}
     // JSON数据需要以"favorites": [[商品编号，评分值],...]的形式储存
     // viewHistory 记录用户浏览商品的次数，用于推荐算法
     // shoppingCart 记录用户购物车中的商品和数量
 };
 
+// 用户快照：按用户ID升序的只读用户记录，记录本身以写时复制方式共享，持有期间内容不会变化。
+// 具体形式由提供方决定（如持久化红黑树的某个版本的树根），写出时只需逐条遍历
+class UserSnapshotData {
+public:
+    virtual ~UserSnapshotData() = default;
+
+    [[nodiscard]] virtual size_t size() const = 0;
+
+    virtual void forEach(const std::function<void(const UserData &)> &visit) const = 0;
+};
+
+using UserSnapshot = std::shared_ptr<const UserSnapshotData>;
+
 // 商品数据结构体
+// name / category 为驻留字符串句柄：复制商品时不复制字符串内容，相同分类只保存一份
 struct ProductData {
     int productId;
-    std::string name;
+    PooledString name;
     double price;
     int stock;
-    std::string category;
+    PooledString category;
     double avgRating; // 平均评分 - 与JSON字段名保持一致
     int reviewers; // 评分人数
 };
 
+/**
+ * @brief 商品查询结果：只记录命中商品在商品容器中的下标，读取时才访问商品
+ *
+ * - 全部商品：不保存下标列表，直接引用商品容器
+ * - 分类筛选：直接引用分类倒排表，不复制
+ * - 关键词搜索：持有按相关度排序的下标列表
+ * 结果引用 DataManager 内部的数据，增删商品后失效，需要重新查询；
+ * 需要长期保存时用 materialize() 复制出商品
+ */
+class ProductResultSet {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ProductData;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ProductData *;
+        using reference = const ProductData &;
+
+        const_iterator(const ProductResultSet *set, size_t index) : set(set), index(index) {}
+
+        reference operator*() const { return (*set)[index]; }
+        pointer operator->() const { return &(*set)[index]; }
+        const_iterator &operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        bool operator==(const const_iterator &other) const { return index == other.index; }
+        bool operator!=(const const_iterator &other) const { return index != other.index; }
+
+    private:
+        const ProductResultSet *set;
+        size_t index;
+    };
+
+    ProductResultSet() : source(nullptr), borrowed(nullptr), wholeCatalog(false) {}
+
+    // 全部商品
+    static ProductResultSet all(const std::vector<ProductData> &products) {
+        ProductResultSet result(products);
+        result.wholeCatalog = true;
+        return result;
+    }
+
+    // 引用外部的下标列表（如分类倒排表），列表须比结果活得久
+    static ProductResultSet borrow(const std::vector<ProductData> &products, const std::vector<uint32_t> &slotList) {
+        ProductResultSet result(products);
+        result.borrowed = &slotList;
+        return result;
+    }
+
+    // 持有下标列表
+    static ProductResultSet own(const std::vector<ProductData> &products, std::vector<size_t> slotList) {
+        ProductResultSet result(products);
+        result.owned = std::move(slotList);
+        return result;
+    }
+
+    [[nodiscard]] size_t size() const {
+        if (wholeCatalog) {
+            return source->size();
+        }
+        return borrowed ? borrowed->size() : owned.size();
+    }
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+    // 第 i 个结果在商品容器中的下标
+    [[nodiscard]] size_t slotAt(size_t i) const {
+        if (wholeCatalog) {
+            return i;
+        }
+        return borrowed ? (*borrowed)[i] : owned[i];
+    }
+
+    const ProductData &operator[](size_t i) const { return (*source)[slotAt(i)]; }
+
+    [[nodiscard]] const_iterator begin() const { return {this, 0}; }
+    [[nodiscard]] const_iterator end() const { return {this, size()}; }
+
+    // 复制出命中的商品
+    [[nodiscard]] std::vector<ProductData> materialize() const {
+        return std::vector<ProductData>(begin(), end());
+    }
+
+private:
+    explicit ProductResultSet(const std::vector<ProductData> &products)
+        : source(&products), borrowed(nullptr), wholeCatalog(false) {}
+
+    const std::vector<ProductData> *source;
+    const std::vector<uint32_t> *borrowed;
+    std::vector<size_t> owned;
+    bool wholeCatalog;
+};
+
 // 购物车展示项结构体
 struct CartItemDetails {
     int productId;
@@ -50,6 +173,21 @@ struct CartItemDetails {
     double subtotal;
 };
 
+// 结算结果
+struct CheckoutResult {
+    std::vector<CartItemDetails> items; // 成交的购物车项
+    double totalPrice = 0.0;
+    int totalQuantity = 0;
+    int failedProductId = -1; // 库存不足或不存在的商品ID，-1 表示无
+    int availableStock = 0;   // 失败商品当时的剩余库存
+    std::string message;
+};
+
+// 一批一起落盘的结算（定义见 DataManager.cpp）
+struct CheckoutBatch;
+// 已在内存中生效、等待落盘确认的结算，见 DataManager::beginCheckout
+using CheckoutTicket = std::shared_ptr<CheckoutBatch>;
+
 class DataManager {
 public:
     // 构造函数
@@ -61,10 +199,18 @@ public:
     // 用户数据操作
     bool loadUsersFromJson();
     bool saveUsersToJson();
+    bool saveDirtyUsers();
+    // 整体保存外部持有的用户快照（如 UserManager），序列化在后台线程完成
+    bool saveUserSnapshot(UserSnapshot snapshot);
     bool addUser(const UserData &user);
     bool removeUser(const std::string &username);
     UserData *findUser(const std::string &username);
+    // 注意：直接修改返回的容器不会被脏标记跟踪，之后需调用 saveUsersToJson() 整体保存
     std::vector<UserData> &getUsers();
+    // 整体替换用户数据（一次性重建索引），下次保存时会整体保存
+    void replaceUsers(std::vector<UserData> newUsers);
+    // 通过 findUser 返回的指针修改用户后，需调用此函数标记该用户已变化
+    void markUserDirty(const std::string &username);
 
     // 商品数据操作
     bool loadProductsFromJson();
@@ -75,17 +221,43 @@ public:
     std::vector<ProductData> &getProducts();
 
     // 商品筛选与搜索功能（保留常用的）
-    [[nodiscard]] std::vector<ProductData> searchProducts(const std::string &keyword) const;
-    [[nodiscard]] std::vector<ProductData> filterByCategory(const std::string &category) const;
+    // 搜索结果按相关度排序：名称完全匹配 > 名称前缀 > 名称包含 > 分类匹配，同级按评分
+    // 返回的结果只记录商品下标，增删商品后失效
+    [[nodiscard]] ProductResultSet searchProducts(const std::string &keyword);
+    [[nodiscard]] ProductResultSet filterByCategory(const std::string &category);
+    // 组合筛选：关键词、分类、价格区间、库存，一次得到结果与各分面计数
+    ProductQueryResult queryProducts(const ProductQuery &query);
+    // 范围 + 排序 + 分页：例如价格在 50~200 之间按平均评分降序的第 3 页
+    ProductPage queryProductRange(const ProductRangeQuery &query);
+    // 按有序索引把查询结果排列为指定字段的升序或降序，同值按下标升序
+    void sortProducts(std::vector<size_t> &matches, ProductSortKey key, bool descending);
+    // 前缀补全：返回以 prefix 开头的商品名称/分类，按热度与评分排序
+    std::vector<ProductCompletion> completeProducts(const std::string &prefix, size_t limit = 8);
+
+    // 持久化：保存操作由后台线程完成，flush() 等待此前提交的写入全部落盘，
+    // 返回本实例提交的写入是否全部成功（其他实例的失败不影响结果）
+    bool flush();
+    [[nodiscard]] PersistenceMetrics persistenceMetrics() const;
 
     // 购物车相关
     std::vector<CartItemDetails> getShoppingCartDetails(const std::string &username, double &totalPrice,
                                                         int &totalQuantity);
 
     // 用户行为相关方法
+    // 购物车操作与结算互斥，可在结算进行时从其他线程调用；
+    // 其他修改（增删用户/商品、收藏、评分、加载）不能与结算并发
     bool addToCart(const std::string &username, int productId, int quantity);
     bool removeFromCart(const std::string &username, int productId);
     bool updateCartQuantity(const std::string &username, int productId, int newQuantity);
+    // 结算：为购物车全部商品预留库存，扣减库存、移出购物车后等待两个文件落盘，落盘失败时回滚；
+    // 可在多个线程中同时为不同用户结算（同一 DataManager 实例），同时等待落盘的结算合并为一次保存
+    bool checkout(const std::string &username, CheckoutResult &result);
+    // 分步结算，供不能等待落盘的线程（界面线程）使用：
+    // beginCheckout 在内存中完成结算并提交保存，失败返回空票据；waitForCheckout 等待落盘，
+    // 只访问持久化线程，可在其他线程中调用；endCheckout 回到调用 beginCheckout 的线程确认，落盘失败时回滚
+    CheckoutTicket beginCheckout(const std::string &username, CheckoutResult &result);
+    bool waitForCheckout(const CheckoutTicket &ticket);
+    bool endCheckout(const CheckoutTicket &ticket, bool durable, CheckoutResult &result);
     bool addViewHistory(const std::string &username, int productId);
     bool addToFavorites(const std::string &username, int productId, int rating);
     bool removeFromFavorites(const std::string &username, int productId);
@@ -95,31 +267,82 @@ public:
     bool updateProductRating(int productId, int newRating, int oldRating = -1);
 
 private:
+    // 本实例在持久化线程中的提交者标识，写入失败按实例记录
+    PersistenceWorker::Owner persistenceOwner;
+
     // 数据存储
     std::vector<UserData> users;
     std::vector<ProductData> products;
 
+    // 用户增量持久化：users.json 为基础快照，users.d/ 下的分片保存之后变化过的用户
+    static constexpr uint32_t kUserShardCount = 64;
+    std::unordered_set<std::string> deltaUsers; // 自上次整体保存以来变化过的用户（含已删除的）
+    std::unordered_set<uint32_t> dirtyShards;   // 有未保存变化的分片
+    long long userGeneration = 0;               // users.json 的代次，分片只在代次一致时生效
+    bool fullSaveRequired = false;              // 用户数据被整体替换过，增量保存需退回整体保存
+
+    // 哈希索引：用户名 -> users 下标，商品ID -> products 下标
+    FlatHashMap<std::string, size_t> userIndex;
+    FlatHashMap<int, size_t> productIndex;
+    size_t indexedUserCount = 0;    // 建立索引时 users 的大小，用于发现绕过索引的外部增删
+    size_t indexedProductCount = 0; // 同上，对应 products
+
+    // 以下查询索引在第一次查询时才建立，之后随增删商品增量维护（见 ensureQueryIndexes）
+    bool queryIndexesBuilt = false;
+    // 商品名称/分类的 n-gram 倒排索引
+    ProductSearchIndex searchIndex;
+    // 商品名称/分类的前缀补全树
+    ProductAutocomplete autocomplete;
+    // 分类倒排表与价格/库存列，用于组合筛选
+    ProductFacetIndex facetIndex;
+    // 价格、评分、评价人数、库存的有序索引，用于范围查询与分页
+    ProductSortedIndex sortedIndex;
+    // 各商品的可用库存，结算时无锁预留
+    StockLedger stockLedger;
+
+    // 结算：预留库存之外的步骤（读取购物车、扣减库存、提交保存、回滚）与购物车操作在 checkoutMutex 下进行，
+    // 等待落盘时不持有
+    std::mutex checkoutMutex;
+    std::unordered_set<std::string> checkoutUsers; // 正在结算的用户，同一用户不能同时结算
+    std::shared_ptr<CheckoutBatch> openBatch;      // 尚未提交保存的结算，由下一次保存一并落盘
+    std::mutex commitMutex;                        // 同一时刻只有一批结算在等待落盘
+
+    // 结算的各步骤；后两者调用方须持有 checkoutMutex
+    CheckoutTicket stageCheckout(const std::string &username, CheckoutResult &result);
+    bool submitCheckouts(CheckoutBatch &batch);
+    void finishCheckouts(CheckoutBatch &batch, bool durable);
+
     // JSON 文件路径解析（统一定位到程序目录或上级 bin 目录）
     [[nodiscard]] std::string userFile() const;
     [[nodiscard]] std::string productFile() const;
+    [[nodiscard]] std::string userShardDir() const;
+    [[nodiscard]] std::string userShardFile(long long generation, uint32_t shard) const;
 
-    // JSON 转换函数
-    json userToJson(const UserData &user);
-    UserData jsonToUser(const json &j);
-    json productToJson(const ProductData &product);
-    ProductData jsonToProduct(const json &j);
+    // 索引维护辅助函数
+    void rebuildUserIndex();
+    void rebuildProductIndex();
+    void ensureQueryIndexes();
+    void appendUser(UserData user);
+    void eraseUserAt(size_t slot);
+    void eraseProductAt(size_t slot);
+    [[nodiscard]] int availableStock(size_t slot) const;
+
+    // 整体保存的公共部分：推进代次并提交后台写入
+    bool submitFullUserSave(size_t count, std::function<void(json &)> fillUsers);
+
+    // 用户分片辅助函数
+    static uint32_t userShardOf(const std::string &username);
+    void loadUserShards();
+
+    // JSON 转换函数（静态：序列化在后台持久化线程中执行，不能依赖 this）
+    static json userToJson(const UserData &user);
+    static UserData jsonToUser(const json &j);
+    static json productToJson(const ProductData &product);
+    static ProductData jsonToProduct(const json &j);
 
     // 文件操作辅助函数
     bool fileExists(const std::string &filename);
     bool createEmptyJsonFile(const std::string &filename);
-
-    // 辅助函数：在二维数组中查找并更新项目
-    bool updateItemInVector(std::vector<std::vector<int> > &vec, int productId, int newValue);
-    bool removeItemFromVector(std::vector<std::vector<int> > &vec, int productId);
-
-    // 搜索与筛选辅助函数
-    [[nodiscard]] std::string toLowercase(const std::string &str) const;
-    [[nodiscard]] bool containsKeyword(const std::string &text, const std::string &keyword) const;
 };
 
 #endif // DATAMANAGER_H
\ No newline at end of file
@@ -0,0 +1,181 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+
+/**
+ * @brief 开放寻址（线性探测）哈希表
+ *
+ * - 所有元素存放在一段连续数组中，查找只需顺序访问相邻槽位，缓存友好
+ * - 容量始终为 2 的幂，负载因子超过 0.7 时扩容
+ * - 删除采用"后移回填"，不留墓碑，查找长度不会随删除次数退化
+ * - 对 std::hash 的结果再做一次混合：libstdc++ 中整数的 std::hash 是恒等映射，
+ *   直接按掩码取低位时，连续或等间隔的 ID 会集中冲突
+ */
+template <typename K, typename V, typename Hash = std::hash<K> >
+class FlatHashMap {
+public:
+    FlatHashMap() : count(0), mask(0) {}
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    void clear() {
+        table.clear();
+        count = 0;
+        mask = 0;
+    }
+
+    // 预留至少能容纳 n 个元素的空间（不触发扩容）
+    void reserve(size_t n) {
+        size_t capacity = 8;
+        while (capacity * 7 < n * 10) {
+            capacity <<= 1;
+        }
+        if (capacity > table.size()) {
+            rehash(capacity);
+        }
+    }
+
+    V *find(const K &key) {
+        if (count == 0) return nullptr;
+        for (size_t i = indexOf(key);; i = (i + 1) & mask) {
+            Slot &slot = table[i];
+            if (!slot.used) return nullptr;
+            if (slot.key == key) return &slot.value;
+        }
+    }
+
+    const V *find(const K &key) const {
+        return const_cast<FlatHashMap *>(this)->find(key);
+    }
+
+    [[nodiscard]] bool contains(const K &key) const { return find(key) != nullptr; }
+
+    // 插入或覆盖，返回 true 表示新插入
+    bool insert(const K &key, const V &value) {
+        if ((count + 1) * 10 > table.size() * 7) {
+            rehash(table.empty() ? 8 : table.size() * 2);
+        }
+
+        for (size_t i = indexOf(key);; i = (i + 1) & mask) {
+            Slot &slot = table[i];
+            if (!slot.used) {
+                slot.key = key;
+                slot.value = value;
+                slot.used = true;
+                count++;
+                return true;
+            }
+            if (slot.key == key) {
+                slot.value = value;
+                return false;
+            }
+        }
+    }
+
+    // 查找，不存在时插入默认值，返回值的引用（引用在下次插入前有效）
+    V &getOrInsert(const K &key) {
+        if ((count + 1) * 10 > table.size() * 7) {
+            rehash(table.empty() ? 8 : table.size() * 2);
+        }
+
+        for (size_t i = indexOf(key);; i = (i + 1) & mask) {
+            Slot &slot = table[i];
+            if (!slot.used) {
+                slot.key = key;
+                slot.value = V();
+                slot.used = true;
+                count++;
+                return slot.value;
+            }
+            if (slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    // 删除，返回 true 表示找到并删除
+    bool erase(const K &key) {
+        if (count == 0) return false;
+
+        size_t i = indexOf(key);
+        while (true) {
+            if (!table[i].used) return false;
+            if (table[i].key == key) break;
+            i = (i + 1) & mask;
+        }
+
+        // 后移回填：把后续探测链上"可以前移"的元素移到空位，保持探测链连续
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask; table[j].used; j = (j + 1) & mask) {
+            size_t home = indexOf(table[j].key);
+            // home 不在 (hole, j] 区间内时，元素 j 可以移动到 hole
+            bool movable = (hole <= j) ? (home <= hole || home > j) : (home <= hole && home > j);
+            if (movable) {
+                table[hole] = std::move(table[j]);
+                hole = j;
+            }
+        }
+        table[hole].used = false;
+        table[hole].key = K();
+        table[hole].value = V();
+        count--;
+        return true;
+    }
+
+    // 遍历所有元素：f(const K&, V&)
+    template <typename F>
+    void forEach(F &&f) {
+        for (auto &slot : table) {
+            if (slot.used) f(slot.key, slot.value);
+        }
+    }
+
+private:
+    struct Slot {
+        K key{};
+        V value{};
+        bool used = false;
+    };
+
+    std::vector<Slot> table;
+    size_t count;
+    size_t mask;
+
+    [[nodiscard]] size_t indexOf(const K &key) const {
+        uint64_t h = static_cast<uint64_t>(Hash{}(key));
+        // splitmix64 的最终混合步骤
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return static_cast<size_t>(h) & mask;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(table);
+        table.resize(capacity);
+        mask = capacity - 1;
+        count = 0;
+
+        // 直接移动到新位置，避免复制值（值可能是 vector 等较大的对象）
+        for (auto &slot : old) {
+            if (!slot.used) continue;
+            size_t i = indexOf(slot.key);
+            while (table[i].used) {
+                i = (i + 1) & mask;
+            }
+            table[i] = std::move(slot);
+            count++;
+        }
+    }
+};
+
+#endif // FLATHASHMAP_H
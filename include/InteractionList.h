@@ -0,0 +1,150 @@
+#ifndef INTERACTIONLIST_H
+#define INTERACTIONLIST_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// 用户与商品的一次交互记录：购物车中为数量，浏览历史中为浏览次数，收藏中为评分
+struct Interaction {
+    int32_t productId;
+    int32_t value;
+};
+
+/**
+ * @brief 按商品ID升序排列的紧凑交互列表
+ *
+ * - 每条记录 8 字节，全部存放在一段连续数组中；
+ *   原先的 vector<vector<int>> 每条记录都是一次单独的堆分配外加 24 字节的 vector 头
+ * - 查找、更新、删除都先二分定位
+ * - JSON 格式保持不变：[[商品ID, 值], ...]（写出时按商品ID升序）
+ */
+class InteractionList {
+public:
+    using const_iterator = std::vector<Interaction>::const_iterator;
+
+    [[nodiscard]] size_t size() const { return items.size(); }
+    [[nodiscard]] bool empty() const { return items.empty(); }
+    void clear() { items.clear(); }
+    void reserve(size_t n) { items.reserve(n); }
+
+    [[nodiscard]] const_iterator begin() const { return items.begin(); }
+    [[nodiscard]] const_iterator end() const { return items.end(); }
+
+    // 查找商品对应的记录，不存在返回 nullptr
+    [[nodiscard]] const Interaction *find(int productId) const {
+        auto it = lowerBound(productId);
+        return (it != items.end() && it->productId == productId) ? &*it : nullptr;
+    }
+
+    [[nodiscard]] bool contains(int productId) const { return find(productId) != nullptr; }
+
+    // 商品对应的值，不存在时返回 fallback
+    [[nodiscard]] int valueOf(int productId, int fallback) const {
+        const Interaction *item = find(productId);
+        return item ? item->value : fallback;
+    }
+
+    // 插入或覆盖，返回 true 表示新插入
+    bool set(int productId, int value) {
+        auto it = lowerBound(productId);
+        if (it != items.end() && it->productId == productId) {
+            it->value = value;
+            return false;
+        }
+        items.insert(it, Interaction{productId, value});
+        return true;
+    }
+
+    // 累加（不存在时以 delta 插入），返回累加后的值
+    int add(int productId, int delta) {
+        auto it = lowerBound(productId);
+        if (it != items.end() && it->productId == productId) {
+            it->value += delta;
+            return it->value;
+        }
+        items.insert(it, Interaction{productId, delta});
+        return delta;
+    }
+
+    // 删除，返回 true 表示找到并删除
+    bool erase(int productId) {
+        auto it = lowerBound(productId);
+        if (it == items.end() || it->productId != productId) {
+            return false;
+        }
+        items.erase(it);
+        return true;
+    }
+
+    // 所有记录的值之和（购物车总件数、浏览总次数）
+    [[nodiscard]] long long totalValue() const {
+        long long total = 0;
+        for (const auto &item : items) {
+            total += item.value;
+        }
+        return total;
+    }
+
+private:
+    std::vector<Interaction> items;
+
+    std::vector<Interaction>::iterator lowerBound(int productId) {
+        return std::lower_bound(items.begin(), items.end(), productId,
+                                [](const Interaction &item, int id) { return item.productId < id; });
+    }
+
+    [[nodiscard]] std::vector<Interaction>::const_iterator lowerBound(int productId) const {
+        return std::lower_bound(items.begin(), items.end(), productId,
+                                [](const Interaction &item, int id) { return item.productId < id; });
+    }
+
+    template <typename BasicJsonType>
+    friend void to_json(BasicJsonType &j, const InteractionList &list);
+
+    template <typename BasicJsonType>
+    friend void from_json(const BasicJsonType &j, InteractionList &list);
+};
+
+// JSON 写出：[[商品ID, 值], ...]
+template <typename BasicJsonType>
+void to_json(BasicJsonType &j, const InteractionList &list) {
+    j = BasicJsonType::array();
+    for (const auto &item : list.items) {
+        j.push_back(BasicJsonType::array({item.productId, item.value}));
+    }
+}
+
+/**
+ * JSON 读入：兼容旧数据
+ * - 只有商品ID的记录按值为 1 处理（与推荐算法读取浏览历史的方式一致）
+ * - 同一商品出现多次时保留第一条（与原先线性查找时命中的记录一致）
+ * - 格式不正确的记录跳过
+ */
+template <typename BasicJsonType>
+void from_json(const BasicJsonType &j, InteractionList &list) {
+    list.items.clear();
+    if (!j.is_array()) {
+        return;
+    }
+
+    list.items.reserve(j.size());
+    for (const auto &entry : j) {
+        if (!entry.is_array() || entry.empty() || !entry[0].is_number_integer()) {
+            continue;
+        }
+        int value = (entry.size() >= 2 && entry[1].is_number()) ? entry[1].template get<int>() : 1;
+        list.items.push_back(Interaction{entry[0].template get<int>(), value});
+    }
+
+    std::stable_sort(list.items.begin(), list.items.end(),
+                     [](const Interaction &a, const Interaction &b) { return a.productId < b.productId; });
+    list.items.erase(std::unique(list.items.begin(), list.items.end(),
+                                 [](const Interaction &a, const Interaction &b) {
+                                     return a.productId == b.productId;
+                                 }),
+                     list.items.end());
+}
+
+#endif // INTERACTIONLIST_H
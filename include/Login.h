@@ -25,6 +25,12 @@ bool userExists(const std::string &username);
 
 bool login(const std::string &username, const std::string &password);
 
+// 登录并取得用户ID与管理员身份，只查找一次用户
+bool login(const std::string &username, const std::string &password, int &userId, bool &isAdmin);
+
+// 按用户名查找用户ID与管理员身份（哈希索引），用于核对自动登录的会话
+bool lookupUser(const std::string &username, int &userId, bool &isAdmin);
+
 bool changePassword(const std::string &username, const std::string &oldPassword, const std::string &newPassword);
 
 #endif //LOGIN_H
\ No newline at end of file
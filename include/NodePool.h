@@ -0,0 +1,92 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * @brief 定长节点池：按块（约 64KB）批量申请内存，节点在块内连续分配
+ *
+ * - 分配先取空闲链表，再取当前块的下一个位置，都没有时申请新块
+ * - 释放的节点挂回空闲链表（链表指针复用节点自身的存储），之后的分配优先复用
+ * - 全部节点释放后 clear() 把所有块恢复为未使用，重新按地址顺序分配，块本身保留复用
+ * 节点地址在释放前不变；池析构时归还全部块，此前须已释放所有节点
+ */
+template <typename T>
+class NodePool {
+public:
+    NodePool() : freeList(nullptr), current(0), used(0), live(0) {}
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    template <typename... Args>
+    T *create(Args &&...args) {
+        Slot *slot = freeList;
+        if (slot != nullptr) {
+            freeList = slot->next;
+        } else {
+            if (slabs.empty() || used == kSlotsPerSlab) {
+                nextSlab();
+            }
+            slot = &slabs[current][used++];
+        }
+        T *object = new (slot->storage) T(std::forward<Args>(args)...);
+        live++;
+        return object;
+    }
+
+    void destroy(T *object) {
+        if (object == nullptr) {
+            return;
+        }
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    // 所有节点都已 destroy 后调用：丢弃空闲链表，从第一块开始顺序分配
+    void clear() {
+        if (live != 0) {
+            return;
+        }
+        freeList = nullptr;
+        current = 0;
+        used = 0;
+    }
+
+    [[nodiscard]] size_t size() const { return live; }
+    [[nodiscard]] size_t capacity() const { return slabs.size() * kSlotsPerSlab; }
+
+private:
+    union Slot {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static constexpr size_t kSlabBytes = 64 * 1024;
+    static constexpr size_t kSlotsPerSlab = sizeof(Slot) >= kSlabBytes ? 1 : kSlabBytes / sizeof(Slot);
+
+    std::vector<std::unique_ptr<Slot[]> > slabs;
+    Slot *freeList;
+    size_t current; // 正在分配的块
+    size_t used;    // 当前块已分配出的位置数
+    size_t live;
+
+    // 当前块用完：clear() 之后先依次复用已有的块，都用完再申请新块
+    void nextSlab() {
+        if (!slabs.empty() && current + 1 < slabs.size()) {
+            current++;
+        } else {
+            slabs.emplace_back(new Slot[kSlotsPerSlab]);
+            current = slabs.size() - 1;
+        }
+        used = 0;
+    }
+};
+
+#endif // NODEPOOL_H
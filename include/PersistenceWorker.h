@@ -0,0 +1,93 @@
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <cstddef>
+
+// 持久化运行指标（用于观察后台写入队列的状态）
+struct PersistenceMetrics {
+    size_t queueDepth;   // 当前排队等待写入的文件数（同一文件的多次提交已合并）
+    size_t inFlight;     // 正在写入的任务数（0 或 1）
+    size_t submitted;    // 累计提交次数
+    size_t coalesced;    // 被后续提交覆盖、无需单独写入的次数
+    size_t completed;    // 累计成功写入次数
+    size_t failed;       // 累计写入失败次数
+    double lastWriteMs;  // 最近一次序列化+写入耗时（毫秒）
+    double avgWriteMs;   // 平均序列化+写入耗时（毫秒）
+    double maxWriteMs;   // 最大序列化+写入耗时（毫秒）
+};
+
+/**
+ * @brief 后台持久化线程（进程内单例）
+ *
+ * - 调用方在自己的线程上拍下数据快照，把"快照 -> 文本"的序列化函数提交给本线程
+ * - 同一路径在写入前被多次提交时只保留最新的一次（脏标记合并）
+ * - 写入采用 临时文件 -> 刷盘 -> 原子重命名，崩溃时磁盘上要么是旧文件要么是新文件
+ * - flush() 作为屏障，等待此前提交的所有写入完成
+ * - 写入失败按提交者记录：每个提交者（如一个 DataManager 实例）只从 flush() 得知自己提交的写入是否失败
+ */
+class PersistenceWorker {
+public:
+    // 序列化函数：在后台线程中执行，返回要写入文件的完整内容
+    using Serializer = std::function<std::string()>;
+
+    // 提交者标识，0 表示匿名提交
+    using Owner = uint64_t;
+
+    static PersistenceWorker &instance();
+
+    // 分配一个新的提交者标识
+    Owner newOwner();
+
+    // 提交一次写入（非阻塞）；同一路径被合并的多次提交，写入失败时都记为失败
+    void submit(const std::string &path, Serializer serializer, Owner owner = 0);
+
+    // 等待此前提交的所有写入完成，返回 owner 提交的写入自上次 flush(owner) 以来是否全部成功，
+    // 并清除其失败记录；不影响其他提交者的失败记录
+    bool flush(Owner owner = 0);
+
+    [[nodiscard]] PersistenceMetrics metrics() const;
+
+    // 同步原子写文件：写临时文件、刷盘后重命名覆盖目标文件
+    static bool writeFileAtomically(const std::string &path, const std::string &content);
+
+    PersistenceWorker(const PersistenceWorker &) = delete;
+    PersistenceWorker &operator=(const PersistenceWorker &) = delete;
+
+private:
+    PersistenceWorker();
+
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable; // 有新任务
+    std::condition_variable idle;          // 队列清空且没有正在写入的任务
+
+    struct PendingWrite {
+        Serializer serializer;    // 最新的序列化函数
+        std::vector<Owner> owners; // 合并到这次写入的全部提交者
+    };
+
+    std::deque<std::string> order;                         // 待写入路径（按首次提交顺序）
+    std::unordered_map<std::string, PendingWrite> pending; // 路径 -> 待写入内容
+    bool writing;
+    std::unordered_set<Owner> failedOwners; // 有尚未通过 flush 报告的失败写入的提交者
+    std::atomic<Owner> nextOwner;
+
+    PersistenceMetrics stats;
+    double totalWriteMs;
+
+    std::thread thread;
+};
+
+#endif // PERSISTENCEWORKER_H
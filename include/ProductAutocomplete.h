@@ -0,0 +1,94 @@
+#ifndef PRODUCTAUTOCOMPLETE_H
+#define PRODUCTAUTOCOMPLETE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "FlatHashMap.h"
+
+struct ProductData;
+
+// 一条补全建议
+struct ProductCompletion {
+    std::string text;  // 展示文本（商品名称或分类的原文）
+    bool isCategory;   // true 表示分类，false 表示商品名称
+    int productCount;  // 使用该名称/分类的商品数
+};
+
+/**
+ * @brief 商品名称/分类的前缀补全（压缩前缀树）
+ *
+ * - 名称与分类先按 ProductSearchIndex::normalize 归一化，同名商品合并为一个词条
+ * - 商品名称除整体外，还以其中每个单词（空格、连字符等分隔符之后）开头的后缀作为键，
+ *   输入 "iph" 也能补全出 "Apple iPhone 15"
+ * - 每个节点缓存子树中排名前 kCachedTop 的词条，查询只需沿前缀走到对应节点
+ * - 排名：热度（各商品评价人数 + 1 之和）降序，其次平均评分降序
+ *
+ * 词条按文本而非商品下标索引，删除商品时无需调整其他商品的下标
+ */
+class ProductAutocomplete {
+public:
+    static constexpr size_t kCachedTop = 8;
+
+    ProductAutocomplete();
+
+    void clear();
+
+    void build(const std::vector<ProductData> &products);
+
+    void addProduct(const ProductData &product);
+
+    // 按商品当前的名称、分类与评分撤销其贡献（评分变化时需先删除再添加）
+    void removeProduct(const ProductData &product);
+
+    // 已加入的商品数
+    [[nodiscard]] size_t productCount() const { return totalProducts; }
+
+    // 返回以 prefix 开头的前 limit 条建议；空前缀返回空列表
+    [[nodiscard]] std::vector<ProductCompletion> complete(const std::string &prefix, size_t limit) const;
+
+private:
+    struct Term {
+        std::string text;
+        std::u32string key;
+        bool isCategory = false;
+        int products = 0;        // 为 0 表示词条已删除，可复用
+        long long popularity = 0;
+        double ratingSum = 0.0;
+    };
+
+    struct Node {
+        std::u32string label;            // 从父节点到本节点的边上的字符
+        std::vector<uint32_t> children;  // 按 label 首字符升序
+        std::vector<uint32_t> terms;     // 键恰好在本节点结束的词条
+        std::vector<uint32_t> top;       // 子树中排名靠前的词条（已排序）
+    };
+
+    std::vector<Term> terms;
+    std::vector<uint32_t> freeTerms;
+    FlatHashMap<std::u32string, uint32_t> nameTerms;
+    FlatHashMap<std::u32string, uint32_t> categoryTerms;
+    std::vector<Node> nodes; // nodes[0] 为根节点
+    size_t totalProducts;
+
+    void contribute(std::string_view text, bool isCategory, const ProductData &product, int sign);
+
+    // 词条 a 是否排在 b 之前
+    [[nodiscard]] bool ranksBefore(uint32_t a, uint32_t b) const;
+
+    [[nodiscard]] std::vector<std::u32string> keysOf(const Term &term) const;
+    [[nodiscard]] int findChild(uint32_t node, char32_t first) const;
+    uint32_t insertKey(const std::u32string &key);
+    bool pathTo(const std::u32string &key, std::vector<uint32_t> &path) const;
+
+    // 词条排名上升：沿所有键的路径更新缓存
+    void promote(uint32_t term);
+    // 词条排名下降或被删除：自底向上重算缓存中含有该词条的节点
+    void demote(uint32_t term);
+    void recomputeTop(uint32_t node);
+    void collectAll(uint32_t node, std::vector<uint32_t> &out) const;
+};
+
+#endif // PRODUCTAUTOCOMPLETE_H
@@ -0,0 +1,89 @@
+#ifndef PRODUCTFACETINDEX_H
+#define PRODUCTFACETINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "FlatHashMap.h"
+#include "StringPool.h"
+
+struct ProductData;
+
+// 组合筛选条件
+struct ProductQuery {
+    std::string keyword;     // 关键词，空表示不限
+    std::string category;    // 分类，空或"全部"表示不限
+    double minPrice = -1.0;  // 最低价格，小于 0 表示不限
+    double maxPrice = -1.0;  // 最高价格，小于 0 表示不限
+    bool inStockOnly = false; // 只看有库存的商品
+};
+
+// 单个分类的命中数
+struct CategoryCount {
+    std::string category;
+    int count;
+};
+
+// 组合筛选结果
+struct ProductQueryResult {
+    std::vector<size_t> matches;               // 命中的商品下标：有关键词时按相关度，否则按下标顺序
+    std::vector<CategoryCount> categoryCounts; // 各分类的命中数（不计分类条件）
+    int inStockCount = 0;                      // 满足除库存外其余条件、且有库存的商品数
+    int outOfStockCount = 0;                   // 满足除库存外其余条件、但没有库存的商品数
+    double minPrice = 0.0;                     // 满足除价格外其余条件的商品的价格范围
+    double maxPrice = 0.0;
+};
+
+/**
+ * @brief 商品分面筛选索引
+ *
+ * - 分类 -> 商品下标的倒排表（升序），以及按下标排列的价格、分类、库存列
+ * - 关键词、分类、价格区间、库存四个条件各自表示为位图，按 64 位字逐字求交集
+ * - 结果与各分面的计数在同一遍扫描中得到：每个分面的计数只排除该分面自身的条件
+ *
+ * 下标与 DataManager::products 的下标一致，删除商品时后续下标整体前移一位
+ */
+class ProductFacetIndex {
+public:
+    void clear();
+
+    void build(const std::vector<ProductData> &products);
+
+    // 追加商品，slot 必须等于当前已索引的商品数
+    void addProduct(size_t slot, const ProductData &product);
+
+    // 删除下标为 slot 的商品，之后的下标整体前移一位
+    void removeProduct(size_t slot);
+
+    // 商品的分类、价格或库存变化后调用
+    void updateProduct(size_t slot, const ProductData &product);
+
+    [[nodiscard]] size_t size() const { return categoryOf.size(); }
+
+    // 指定分类的商品下标（升序）；分类不存在时返回 nullptr
+    [[nodiscard]] const std::vector<uint32_t> *categorySlots(std::string_view category) const;
+
+    /**
+     * @brief 执行组合筛选
+     * @param query 筛选条件（keyword 字段由调用方通过 ranked 传入）
+     * @param ranked 关键词搜索得到的按相关度排序的下标；nullptr 表示不限关键词
+     */
+    [[nodiscard]] ProductQueryResult query(const ProductQuery &query, const std::vector<size_t> *ranked) const;
+
+private:
+    std::vector<PooledString> categoryNames;             // 分类 ID -> 分类名
+    FlatHashMap<std::string_view, uint32_t> categoryIds; // 分类名（指向驻留字符串）-> 分类 ID
+    std::vector<std::vector<uint32_t> > postings;    // 分类 ID -> 升序的商品下标
+
+    // 按商品下标排列的列
+    std::vector<uint32_t> categoryOf;
+    std::vector<double> prices;
+    std::vector<uint64_t> inStock; // 位图：库存大于 0
+
+    uint32_t categoryIdOf(const PooledString &category);
+    void setInStock(size_t slot, bool value);
+};
+
+#endif // PRODUCTFACETINDEX_H
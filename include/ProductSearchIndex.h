@@ -0,0 +1,63 @@
+#ifndef PRODUCTSEARCHINDEX_H
+#define PRODUCTSEARCHINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "FlatHashMap.h"
+
+struct ProductData;
+
+/**
+ * @brief 商品名称/分类的 n-gram 倒排索引
+ *
+ * - 文本先按 UTF-8 解码为字符（码点），再做大小写与全角字母数字的归一化，中文按单字切分
+ * - 为每个字符位置建立 1/2/3-gram，每个 gram 对应一个按商品下标升序排列的倒排表
+ * - 查询时取关键词的全部 3-gram（不足 3 个字符时取整个关键词）求倒排表交集，
+ *   再在候选商品上核对子串，最后按匹配质量和评分排序
+ *
+ * 索引中的"下标"与 DataManager::products 的下标一致，
+ * 删除商品时后续下标整体前移一位，与 products 的删除方式相同
+ */
+class ProductSearchIndex {
+public:
+    void clear();
+
+    void build(const std::vector<ProductData> &products);
+
+    // 追加商品，slot 必须等于当前已索引的商品数
+    void addProduct(size_t slot, const ProductData &product);
+
+    // 删除下标为 slot 的商品，之后的下标整体前移一位
+    void removeProduct(size_t slot);
+
+    // 已索引的商品数
+    [[nodiscard]] size_t size() const { return entries.size(); }
+
+    // 搜索，返回按相关度排序的商品下标；空关键词返回空列表（由调用方决定是否返回全部）
+    [[nodiscard]] std::vector<size_t> search(const std::string &keyword,
+                                             const std::vector<ProductData> &products) const;
+
+    // 文本归一化：UTF-8 解码，ASCII 与全角字母转小写，全角数字/符号转半角
+    static std::u32string normalize(std::string_view text);
+
+private:
+    // 每个商品归一化后的文本，用于核对候选结果
+    struct Entry {
+        std::u32string name;
+        std::u32string category;
+    };
+
+    std::vector<Entry> entries;
+    FlatHashMap<uint64_t, std::vector<uint32_t> > postings; // gram -> 升序的商品下标
+
+    // 把 n(1~3) 个字符打包为一个 64 位 key（码点不超过 21 位，且归一化后不含 0）
+    static uint64_t gramKey(const char32_t *text, size_t n);
+
+    // 收集文本中所有不重复的 1/2/3-gram
+    static void collectGrams(const std::u32string &text, std::vector<uint64_t> &grams);
+};
+
+#endif // PRODUCTSEARCHINDEX_H
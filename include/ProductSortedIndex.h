@@ -0,0 +1,87 @@
+#ifndef PRODUCTSORTEDINDEX_H
+#define PRODUCTSORTEDINDEX_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ProductData;
+
+// 可用于范围查询与排序的商品字段
+enum class ProductSortKey {
+    Price,
+    AvgRating,
+    Reviewers,
+    Stock
+};
+
+// 范围 + 排序 + 分页查询
+struct ProductRangeQuery {
+    ProductSortKey rangeKey = ProductSortKey::Price; // 按哪个字段限定范围
+    double minValue = -1.0;                          // 范围下限（含），小于 0 表示不限
+    double maxValue = -1.0;                          // 范围上限（含），小于 0 表示不限
+    ProductSortKey sortKey = ProductSortKey::Price;  // 按哪个字段排序
+    bool descending = false;
+    size_t offset = 0;
+    size_t limit = 20;
+};
+
+// 一页查询结果
+struct ProductPage {
+    std::vector<size_t> matches; // 本页商品下标，按排序字段排列（同值按下标）
+    size_t total = 0;            // 满足范围条件的商品总数
+};
+
+/**
+ * @brief 商品价格、平均评分、评价人数、库存的有序二级索引
+ *
+ * - 每个字段一个按 (值, 下标) 升序排列的连续数组，范围查询两次二分即可定位，
+ *   范围字段与排序字段相同时取一页的代价为 O(log P + 页大小)
+ * - 两者不同时在"按排序字段顺序遍历并检查范围"与"取出范围再排序"之间选代价较低的一种
+ * - 降序时值从大到小，同值仍按下标升序
+ * - 同时按下标保存各字段的当前值，修改商品时据此找到旧位置
+ *
+ * 下标与 DataManager::products 的下标一致，删除商品时后续下标整体前移一位
+ */
+class ProductSortedIndex {
+public:
+    static constexpr size_t kKeyCount = 4;
+
+    void clear();
+
+    void build(const std::vector<ProductData> &products);
+
+    // 追加商品，slot 必须等于当前已索引的商品数
+    void addProduct(size_t slot, const ProductData &product);
+
+    // 删除下标为 slot 的商品，之后的下标整体前移一位
+    void removeProduct(size_t slot);
+
+    // 商品的价格、评分、评价人数或库存变化后调用
+    void updateProduct(size_t slot, const ProductData &product);
+
+    [[nodiscard]] size_t size() const { return values[0].size(); }
+
+    [[nodiscard]] ProductPage query(const ProductRangeQuery &query) const;
+
+    // 把一组商品下标按字段排列（同值按下标升序），用于给组合筛选的结果排序
+    void order(std::vector<size_t> &matches, ProductSortKey key, bool descending) const;
+
+    static double valueOf(const ProductData &product, ProductSortKey key);
+
+private:
+    struct Entry {
+        double value;
+        uint32_t slot;
+    };
+
+    std::vector<Entry> sorted[kKeyCount];  // 每个字段按 (value, slot) 升序
+    std::vector<double> values[kKeyCount]; // 每个字段按下标排列的当前值
+
+    static bool entryLess(const Entry &a, const Entry &b);
+    static bool entryGreater(const Entry &a, const Entry &b);
+    void insertEntry(size_t key, double value, uint32_t slot);
+    void eraseEntry(size_t key, double value, uint32_t slot);
+};
+
+#endif // PRODUCTSORTEDINDEX_H
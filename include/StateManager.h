@@ -7,6 +7,7 @@
 #include <QSettings>
 #include <QDebug>
 #include <QDateTime>
+#include <functional>
 
 // 程序状态枚举
 enum AppState {
@@ -26,10 +27,21 @@ enum AppState {
     STATE_PRODUCT_DETAIL = 13
 };
 
+// 登录会话：不透明令牌对应的用户信息，权限判断只查会话表；自动登录时按用户名核对一次用户数据
+struct SessionInfo {
+    int userId;
+    bool isAdmin;
+    qint64 expiresAt; // 过期时间，自 1970-01-01 起的毫秒数
+};
+
+// 会话有效期（天）
+constexpr int kSessionLifetimeDays = 7;
+
 // 全局状态变量
 extern AppState g_currentState;
 extern bool g_isLoggedIn;
 extern QString g_currentUsername;
+extern QString g_sessionToken; // 当前登录的会话令牌
 
 // 状态管理函数声明
 
@@ -62,4 +74,26 @@ void loadAppState();
 //判断是否为管理员
 bool isCurrentUserAdmin(const std::string &username);
 
+// 会话管理（会话表随 saveAppState 保存到配置）
+
+// 为已验证身份的用户建立会话，返回新令牌
+QString createSession(int userId, bool isAdmin);
+
+// 按令牌查找未过期的会话，O(1)；已过期的会话同时移除
+bool findSession(const QString &token, SessionInfo &info);
+
+void revokeSession(const QString &token);
+
+// 用户被删除或权限变化后同步其全部会话（只遍历会话表）
+void revokeUserSessions(int userId);
+
+void updateUserSessions(int userId, bool isAdmin);
+
+// 用户数据整体重新加载后同步全部会话：lookup 按用户ID查找用户并给出当前的管理员身份，
+// 找不到的用户的会话撤销，权限变化的会话更新
+void refreshSessions(const std::function<bool(int userId, bool &isAdmin)> &lookup);
+
+// 当前会话是否为管理员会话
+bool isCurrentSessionAdmin();
+
 #endif // !STATEMANAGER_H
@@ -0,0 +1,50 @@
+#ifndef STOCKLEDGER_H
+#define STOCKLEDGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct ProductData;
+
+/**
+ * @brief 按商品下标排列的可用库存计数，供结算时无锁预留库存
+ *
+ * - 每个商品一个原子计数，预留用 CAS 循环：剩余不足时失败，计数不会变为负数
+ * - 不同商品的预留互不阻塞，同一商品的并发预留只在 CAS 冲突时重试
+ * - 下标与 DataManager::products 一致，删除商品时后续下标整体前移一位
+ *
+ * 增删商品会移动计数，只能在没有结算进行时调用（与其他商品索引的约定相同）
+ */
+class StockLedger {
+public:
+    void clear();
+
+    void build(const std::vector<ProductData> &products);
+
+    // 追加商品，slot 必须等于当前已记录的商品数
+    void addProduct(size_t slot, int stock);
+
+    // 删除下标为 slot 的商品，之后的下标整体前移一位
+    void removeProduct(size_t slot);
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] int available(size_t slot) const;
+
+    // 剩余库存不少于 quantity 时扣减并返回 true，否则不做任何修改
+    bool tryReserve(size_t slot, int quantity);
+
+    // 归还预留的库存
+    void release(size_t slot, int quantity);
+
+private:
+    std::unique_ptr<std::atomic<int>[]> counters;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    void grow(size_t minCapacity);
+};
+
+#endif // STOCKLEDGER_H
@@ -0,0 +1,113 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <QString>
+
+/**
+ * @brief 进程内的字符串驻留池（用于商品名称和分类）
+ *
+ * - 相同内容的字符串只保存一份，分类这类大量重复的字符串只占一份内存
+ * - 字符串依次写入 64KB 的大块内存（bump 分配），不为每个字符串单独分配堆内存
+ * - 驻留的字符串在进程结束前不会释放或移动，string_view 永久有效，
+ *   因此后台持久化线程、推荐模块持有的商品副本都可以安全引用
+ * - intern() 加锁，读取已驻留的字符串无需加锁
+ *
+ * 去重表是只存指针的开放寻址表（每槽 8 字节），哈希值与长度写在池内字符串之前，
+ * 比较和扩容时不必重新计算哈希；商品名称大多互不相同，表本身不能比字符串还大
+ */
+class StringPool {
+public:
+    static StringPool &instance();
+
+    // 返回与 text 内容相同的驻留字符串（以 '\0' 结尾）
+    std::string_view intern(std::string_view text);
+
+    // 已驻留的字符串数与占用的字节数
+    [[nodiscard]] size_t stringCount() const;
+    [[nodiscard]] size_t bytesUsed() const;
+
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+private:
+    StringPool();
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    // 池内每个字符串前的头部
+    struct Header {
+        uint32_t hash;
+        uint32_t length;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<const char *> table; // 开放寻址，线性探测；元素指向字符串内容，nullptr 为空槽
+    size_t count;
+    std::vector<std::unique_ptr<char[]> > blocks;
+    size_t blockUsed;
+    size_t totalBytes;
+
+    static uint32_t hashOf(std::string_view text);
+    static const Header &headerOf(const char *text);
+    void grow();
+    char *allocate(size_t size);
+};
+
+/**
+ * @brief 指向驻留字符串的句柄
+ *
+ * 只有一个 string_view 大小，复制 ProductData 时不再复制字符串内容；
+ * 相同内容的句柄指向同一地址，相等比较只需比较指针
+ */
+class PooledString {
+public:
+    PooledString() = default;
+    PooledString(std::string_view text) : interned(StringPool::instance().intern(text)) {}
+    PooledString(const std::string &text) : PooledString(std::string_view(text)) {}
+    PooledString(const char *text) : PooledString(std::string_view(text)) {}
+
+    [[nodiscard]] std::string_view view() const { return interned; }
+    [[nodiscard]] const char *data() const { return interned.empty() ? "" : interned.data(); }
+    [[nodiscard]] size_t size() const { return interned.size(); }
+    [[nodiscard]] bool empty() const { return interned.empty(); }
+
+    [[nodiscard]] std::string str() const { return std::string(interned); }
+    [[nodiscard]] QString toQString() const {
+        return QString::fromUtf8(interned.data(), static_cast<qsizetype>(interned.size()));
+    }
+
+    operator std::string_view() const { return interned; }
+    operator std::string() const { return str(); }
+
+    bool operator==(const PooledString &other) const { return interned.data() == other.interned.data(); }
+    bool operator!=(const PooledString &other) const { return !(*this == other); }
+    bool operator==(std::string_view text) const { return interned == text; }
+    bool operator!=(std::string_view text) const { return interned != text; }
+    bool operator==(const std::string &text) const { return interned == text; }
+    bool operator!=(const std::string &text) const { return interned != text; }
+    bool operator==(const char *text) const { return interned == text; }
+    bool operator!=(const char *text) const { return interned != text; }
+
+private:
+    std::string_view interned;
+};
+
+// JSON 写出为普通字符串
+template <typename BasicJsonType>
+void to_json(BasicJsonType &j, const PooledString &text) {
+    j = std::string(text.view());
+}
+
+template <typename BasicJsonType>
+void from_json(const BasicJsonType &j, PooledString &text) {
+    text = PooledString(j.template get<std::string>());
+}
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,147 @@
+#ifndef USERBTREE_H
+#define USERBTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "NodePool.h"
+
+struct UserData;
+
+/**
+ * @brief 按用户ID组织的 B+ 树，UserManager 的另一种索引后端
+ *
+ * - 节点按 64 字节（缓存行）对齐，一个节点保存一段连续的键；键数组定长，节点内查找是对
+ *   整个数组的定长比较计数（按键数屏蔽未使用的位置），可以向量化，没有分支；
+ *   32 路分支，千万用户时树高为 5
+ * - 键与值分开存放：叶子的键数组连续排列，值只是用户记录的指针，记录本身在节点之外
+ * - 叶子按键升序双向链接，范围扫描沿叶子链表顺序读取
+ * - 内部节点记录每个孩子子树中的键数，支持按名次定位（select / rank），用于分页
+ * - 节点已满时分裂；插入位置在节点末尾（用户ID递增分配）时左节点保持满，避免只有半满的节点
+ * - 删除只在节点变空时回收节点，不做借位与合并，树高不会因删除而增加
+ */
+class UserBTree {
+public:
+    using Record = std::shared_ptr<const UserData>;
+
+    static constexpr int kLeafCapacity = 32; // 叶子最多保存的键数
+    static constexpr int kInnerFanout = 32;  // 内部节点最多的孩子数
+
+private:
+    // 未使用位置的填充值，只为数组内容确定，不参与比较
+    static constexpr int kEmptyKey = std::numeric_limits<int>::max();
+
+    struct Node {
+        bool leaf;
+        int count; // 叶子为键数，内部节点为孩子数
+    };
+
+    struct alignas(64) Leaf : Node {
+        Leaf() : Node{true, 0}, prev(nullptr), next(nullptr) { std::fill_n(keys, kLeafCapacity, kEmptyKey); }
+        int keys[kLeafCapacity];
+        Leaf *prev;
+        Leaf *next;
+        Record values[kLeafCapacity];
+    };
+
+    struct alignas(64) Inner : Node {
+        Inner() : Node{false, 0} { std::fill_n(keys, kInnerFanout - 1, kEmptyKey); }
+        int keys[kInnerFanout - 1];  // keys[i] 不大于 children[i + 1] 子树中的任何键，且大于 children[i] 中的键
+        uint32_t sizes[kInnerFanout]; // 各孩子子树中的键数
+        Node *children[kInnerFanout];
+    };
+
+public:
+    /**
+     * @brief 指向某个叶子中的一个位置；越过最后一个键后与默认构造的游标相等
+     *
+     * 树被修改后游标失效
+     */
+    class Cursor {
+    public:
+        Cursor() : leaf(nullptr), slot(0) {}
+
+        [[nodiscard]] const Record &record() const { return leaf->values[slot]; }
+
+        void next() {
+            if (++slot >= leaf->count) {
+                leaf = leaf->next;
+                slot = 0;
+            }
+        }
+
+        bool operator==(const Cursor &other) const { return leaf == other.leaf && slot == other.slot; }
+        bool operator!=(const Cursor &other) const { return !(*this == other); }
+
+    private:
+        friend class UserBTree;
+        Cursor(const Leaf *leaf, int slot) : leaf(leaf), slot(slot) {}
+
+        const Leaf *leaf;
+        int slot;
+    };
+
+    UserBTree() : root(nullptr), head(nullptr), count(0) {}
+    ~UserBTree() { clear(); }
+    UserBTree(const UserBTree &) = delete;
+    UserBTree &operator=(const UserBTree &) = delete;
+
+    void clear();
+
+    // 由按用户ID严格升序的记录一次性建树，O(n)，叶子与内部节点都填满
+    void build(const std::vector<Record> &sorted);
+
+    // 以 record->userId 为键插入，键已存在时返回 false
+    bool insert(Record record);
+
+    // 删除并返回键对应的记录，不存在时返回空指针
+    Record erase(int userId);
+
+    [[nodiscard]] Record *find(int userId);
+    [[nodiscard]] const Record *find(int userId) const;
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] Cursor begin() const { return count > 0 ? Cursor(head, 0) : Cursor(); }
+
+    // 第 k 个键（按用户ID升序，从 0 开始）的位置，越界返回末尾
+    [[nodiscard]] Cursor select(size_t k) const;
+
+    // 第一个不小于 userId 的键的位置
+    [[nodiscard]] Cursor lowerBound(int userId) const;
+
+    // 用户ID小于 userId 的键数
+    [[nodiscard]] size_t rank(int userId) const;
+
+private:
+    // 节点分裂后交给父节点的新右节点
+    struct Split {
+        Node *right = nullptr;
+        int key = 0;       // 右节点的分隔键：不大于右节点子树中的任何键
+        uint32_t size = 0; // 右节点子树中的键数
+    };
+
+    bool insertInto(Node *node, int key, Record &record, Split &split);
+
+    bool eraseFrom(Node *node, int key, Record &removed);
+
+    void insertChild(Inner *inner, int slot, int key, Node *child, uint32_t size);
+
+    void removeChild(Inner *inner, int slot);
+
+    // userId 应在的叶子
+    const Leaf *descend(int userId) const;
+
+    void destroy(Node *node);
+
+    Node *root;
+    Leaf *head; // 最左的叶子
+    size_t count;
+    NodePool<Leaf> leafPool;
+    NodePool<Inner> innerPool;
+};
+
+#endif // USERBTREE_H
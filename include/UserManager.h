@@ -10,29 +10,109 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include "DataManager.h"
+#include "FlatHashMap.h"
+#include "UserBTree.h"
+#include "UserRBTree.h"
+
+// 用户索引（按用户ID）的存储结构，构造 UserManager 时选定
+enum class UserIndexBackend {
+    RedBlackTree, // 持久化红黑树，每个节点一个用户，快照 O(1)，见 UserRBTree
+    BPlusTree     // 缓存行对齐的 B+ 树，每个节点保存一段连续的用户ID，见 UserBTree
+};
 
-// 红黑树节点颜色
-enum Color { RED, BLACK };
-
-// 红黑树节点结构
-struct RBNode {
-    int userId;
-    UserData userData;
-    RBNode* left;
-    RBNode* right;
-    RBNode* parent;
-    Color color;
+// 用户统计，随插入、删除、修改增量维护，读取为 O(1)
+struct UserStatistics {
+    int totalUsers = 0;
+    int adminUsers = 0;
+    int activeUsers = 0;        // 购物车或浏览历史不为空的用户数
+    long long cartItems = 0;    // 各用户购物车中的商品种类数之和
+    long long cartQuantity = 0; // 各用户购物车中的商品件数之和
+    long long browseItems = 0;  // 各用户浏览过的商品数之和
 };
 
+/**
+ * @brief 用户管理：按用户ID组织的有序索引（红黑树或 B+ 树，构造时选定），另有用户名索引
+ *
+ * 两种后端对外行为一致：按ID升序遍历与分页、按名次定位、增删改与统计都相同
+ *
+ * 线程安全：公开接口内部加锁，查询持共享锁、可在多个线程并发执行，增删改持独占锁；
+ * 直接遍历（begin()/end()）时调用方须先持有 readLock()
+ */
 class UserManager {
 public:
-    explicit UserManager();
+    /**
+     * @brief 按用户ID升序的只读迭代器：红黑树用定长栈做中序遍历，B+ 树沿叶子链表前进，
+     *        不递归，也不复制用户数据。for (const UserData &user : userManager) { ... }
+     *
+     * 树被修改（增删改用户、重新加载）后迭代器失效
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = UserData;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const UserData *;
+        using reference = const UserData &;
+
+        const_iterator() = default;
+        explicit const_iterator(const UserRBTree::Cursor &cursor) : rbCursor(cursor) {}
+        explicit const_iterator(UserBTree::Cursor cursor) : btCursor(cursor) {}
+
+        reference operator*() const { return *record(); }
+        pointer operator->() const { return record().get(); }
+        // 共享的记录本身，可在释放锁之后继续持有
+        [[nodiscard]] const std::shared_ptr<const UserData> &record() const {
+            return rbCursor != UserRBTree::Cursor() ? rbCursor.record() : btCursor.record();
+        }
+        const_iterator &operator++() { advance(); return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; advance(); return old; }
+        bool operator==(const const_iterator &other) const {
+            return rbCursor == other.rbCursor && btCursor == other.btCursor;
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        void advance() {
+            if (rbCursor != UserRBTree::Cursor())
+                rbCursor.next();
+            else
+                btCursor.next();
+        }
+
+        UserRBTree::Cursor rbCursor; // 红黑树后端
+        UserBTree::Cursor btCursor;  // B+ 树后端
+    };
+
+    explicit UserManager(UserIndexBackend backend = UserIndexBackend::RedBlackTree);
     ~UserManager();
 
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const { return const_iterator(); }
+
+    [[nodiscard]] UserIndexBackend backend() const { return indexBackend; }
+
+    // 遍历期间持有的共享锁
+    [[nodiscard]] std::shared_lock<std::shared_mutex> readLock() const {
+        return std::shared_lock<std::shared_mutex>(treeMutex);
+    }
+
     // ========== QML 接口函数 ==========
     QVariantList getAllUsers();
 
+    // 按用户ID升序分页：跳过前 offset 个用户，最多返回 limit 个，O(log n + limit)
+    QVariantList getUsers(int offset, int limit);
+
+    int getUserCount() const;
+
+    // 用户在按ID升序排列中的位置（从 0 开始），不存在返回 -1
+    int getUserIndex(int userId) const;
+
     bool addUser(const QString &username, const QString &password, bool isAdmin = false);
 
     bool deleteUser(int userId);
@@ -47,54 +127,68 @@ public:
 
     bool saveToFile();
 
+    // 当前全部用户（按ID升序）的只读快照，之后的修改不影响快照：
+    // 红黑树后端只复制树根指针（O(1)），B+ 树后端复制记录指针（O(n)，不复制用户数据）
+    [[nodiscard]] UserSnapshot snapshot() const;
+
     bool loadFromFile();
 
     void refreshData();
 
 private:
-    // ========== 红黑树操作函数 ==========
-    RBNode *newNode(const UserData &userData);
-
-    void leftRotate(RBNode **root, RBNode *x);
-
-    void rightRotate(RBNode **root, RBNode *y);
-
-    void insertFixup(RBNode **root, RBNode *z);
-
+    // ========== 索引操作（按后端分派） ==========
     bool insertUser(const UserData &userData);
 
-    RBNode *searchUser(int userId);
+    bool removeUser(int userId);
 
-    RBNode *searchUserByName(const std::string &username);
+    // 用户ID对应的记录，不存在返回 nullptr
+    const std::shared_ptr<const UserData> *findRecord(int userId) const;
 
-    RBNode *searchUserByNameHelper(RBNode *node, const std::string &username);
+    // 用同一用户ID的新记录替换旧记录（写时复制），不改动用户名索引与统计
+    void replaceRecord(std::shared_ptr<const UserData> record);
 
-    RBNode *minimum(RBNode *node);
+    const UserData *findUserByName(const std::string &username) const;
 
-    void deleteFixup(RBNode **root, RBNode *x, RBNode *xParent);
+    [[nodiscard]] int userCount() const;
 
-    bool deleteUserNode(int userId);
+    // 第 k 个用户（按用户ID升序，从 0 开始）处的迭代器，越界返回 end()
+    [[nodiscard]] const_iterator iteratorAt(int k) const;
 
-    void collectAllUsers(RBNode *node, std::vector<UserData> &users);
+    void clearUsers();
 
-    void calculateStatistics(RBNode *node, int &total, int &admin, int &regular);
+    // 记录加入（离开）索引时同步用户名索引与统计
+    void indexUser(const UserData &user);
 
-    void destroyTree(RBNode *node);
+    void unindexUser(const UserData &user);
+
+    // 把用户计入（sign = 1）或移出（sign = -1）统计
+    void accountUser(const UserData &user, int sign);
 
     // ========== 数据管理函数 ==========
     void loadUsersFromDataManager();
 
-    void saveUsersToDataManager();
-
     // ========== 辅助函数 ==========
-    QVariantMap userDataToVariantMap(const UserData &user);
+    // 分页转换，调用方须持有 treeMutex
+    QVariantList collectPage(int offset, int limit) const;
+
+    static QVariantMap userDataToVariantMap(const UserData &user);
 
     QString generateSalt();
 
     QString hashPassword(const QString &password, const QString &salt);
 
     // ========== 成员变量 ==========
-    RBNode *root; // 红黑树根节点
+    UserIndexBackend indexBackend; // 构造时选定，之后不变
+    UserRBTree rbtree; // 红黑树后端
+    UserBTree btree; // B+ 树后端
+    UserStatistics stats;
+    // 树、用户名索引、统计与 nextUserId 的读写锁
+    mutable std::shared_mutex treeMutex;
+    // 保护 dataManager 的读写；与 treeMutex 同时持有时先取 treeMutex
+    std::mutex dataMutex;
+    // 用户名 -> 用户记录的哈希索引，与用户ID索引同步维护（插入、删除、修改）
+    // 记录由索引共享持有，在删除或被替换（修改）之前地址不变，两种后端都可以直接保存指针
+    FlatHashMap<std::string, const UserData *> nameIndex;
     DataManager *dataManager; // 数据管理器
     int nextUserId; // 下一个用户ID
 };
@@ -0,0 +1,169 @@
+#ifndef USERRBTREE_H
+#define USERRBTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct UserData;
+
+// 红黑树节点颜色
+enum Color { RED, BLACK };
+
+/**
+ * @brief 红黑树节点：建立后不再修改，可被多个版本的树共享
+ *
+ * 引用计数放在节点内（侵入式），孩子是普通指针：节点从共用的节点池（NodePool）中分配，查找路径上用到的
+ * userId 与左右孩子位于节点开头的同一个缓存行内（std::shared_ptr 做孩子时节点多一个控制块，
+ * 两个孩子各占 16 字节，常常跨越两个缓存行，查找慢一倍以上）
+ */
+struct RBNode {
+    int userId;
+    int size; // 以本节点为根的子树中的节点数，用于按名次定位（顺序统计）
+    const RBNode *left; // 本节点持有左右孩子各一个引用
+    const RBNode *right;
+    Color color;
+    mutable std::atomic<int> refs; // 指向本节点的引用数（父节点与 RBLink）
+    std::shared_ptr<const UserData> userData; // 只读记录，修改时整体替换（写时复制）
+};
+
+/**
+ * @brief 对红黑树节点的一个引用，析构时释放；最后一个引用释放时回收节点并释放其孩子
+ *
+ * 引用计数为原子操作，不同线程可以各自持有、释放同一棵树的引用（如后台线程持有的快照）
+ */
+class RBLink {
+public:
+    RBLink() : node(nullptr) {}
+    explicit RBLink(const RBNode *node) : node(node) { retain(node); }
+    RBLink(const RBLink &other) : node(other.node) { retain(node); }
+    RBLink(RBLink &&other) noexcept : node(other.node) { other.node = nullptr; }
+    ~RBLink() { release(node); }
+
+    RBLink &operator=(RBLink other) noexcept {
+        std::swap(node, other.node);
+        return *this;
+    }
+
+    [[nodiscard]] const RBNode *get() const { return node; }
+    const RBNode *operator->() const { return node; }
+    explicit operator bool() const { return node != nullptr; }
+
+    // 交出引用（由调用方负责释放），自身置空
+    const RBNode *detach() {
+        const RBNode *detached = node;
+        node = nullptr;
+        return detached;
+    }
+
+    static void retain(const RBNode *node) {
+        if (node != nullptr) {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 释放一个引用；计数归零时回收该节点及其不再被引用的子孙
+    static void release(const RBNode *node);
+
+private:
+    const RBNode *node;
+};
+
+/**
+ * @brief 按用户ID组织的持久化红黑树，UserManager 的默认索引后端
+ *
+ * - 节点建立后不再修改：插入、删除、替换记录只复制从根到目标的路径（O(log n) 个节点），
+ *   其余子树由新旧两个版本共享
+ * - 因此取快照只需复制树根指针（O(1)），快照在之后的修改中保持不变，可在其他线程中遍历
+ * - 插入与删除按 Kahrs 的函数式红黑树算法重新平衡（balance / balanceLeft / balanceRight / fuse）
+ * - 节点记录子树大小，支持按名次定位（select / rank），用于分页
+ * - 没有父指针（一个节点可同时属于多个版本，没有唯一的父节点），游标用一个定长栈记录
+ *   尚未访问的祖先，树高不超过 2log2(n+1)，遍历不申请内存
+ * - 节点从所有树共用的节点池分配；丢弃的子树逐层（非递归）收集后一次归还节点池
+ *
+ * 同一棵树的修改须由调用方互斥；快照（root() 的返回值）可在任意线程中只读使用
+ */
+class UserRBTree {
+public:
+    using Record = std::shared_ptr<const UserData>;
+
+    /**
+     * @brief 中序遍历的位置；越过最后一个节点后与默认构造的游标相等
+     *
+     * 游标引用所在版本的节点，该版本的树根须在遍历期间保持存活（树被修改后游标失效）
+     */
+    class Cursor {
+    public:
+        Cursor() : depth(0) {}
+
+        [[nodiscard]] const Record &record() const { return path[depth - 1]->userData; }
+
+        void next() {
+            const RBNode *node = path[--depth];
+            pushLeft(node->right);
+        }
+
+        bool operator==(const Cursor &other) const {
+            return depth == other.depth && (depth == 0 || path[depth - 1] == other.path[depth - 1]);
+        }
+        bool operator!=(const Cursor &other) const { return !(*this == other); }
+
+    private:
+        friend class UserRBTree;
+        static constexpr int kMaxDepth = 64; // int 范围内的用户数，树高不超过 62
+
+        void push(const RBNode *node) { path[depth++] = node; }
+
+        void pushLeft(const RBNode *node) {
+            for (; node != nullptr; node = node->left) {
+                push(node);
+            }
+        }
+
+        const RBNode *path[kMaxDepth]; // 当前节点及尚未访问的祖先，栈顶为当前节点
+        int depth;
+    };
+
+    UserRBTree() = default;
+    UserRBTree(const UserRBTree &) = delete;
+    UserRBTree &operator=(const UserRBTree &) = delete;
+
+    void clear() { top = RBLink(); }
+
+    // 由按用户ID严格升序的记录一次性建树，O(n)，不做旋转
+    void build(const std::vector<Record> &sorted);
+
+    // 以 record->userId 为键插入，键已存在时返回 false
+    bool insert(Record record);
+
+    // 删除并返回键对应的记录，不存在时返回空指针
+    Record erase(int userId);
+
+    // 用同一用户ID的新记录替换旧记录，不存在时返回 false
+    bool replace(Record record);
+
+    [[nodiscard]] const Record *find(int userId) const;
+
+    [[nodiscard]] size_t size() const { return top ? static_cast<size_t>(top->size) : 0; }
+
+    // 当前版本的树根：持有即得到此刻的只读快照，O(1)
+    [[nodiscard]] RBLink root() const { return top; }
+
+    [[nodiscard]] Cursor begin() const { return first(top.get()); }
+
+    // 以 node 为根的树中最小的节点
+    [[nodiscard]] static Cursor first(const RBNode *node);
+
+    // 第 k 个键（按用户ID升序，从 0 开始）的位置，越界返回末尾
+    [[nodiscard]] Cursor select(size_t k) const;
+
+    // 用户ID小于 userId 的键数
+    [[nodiscard]] size_t rank(int userId) const;
+
+private:
+    RBLink top;
+};
+
+#endif // USERRBTREE_H
@@ -2,18 +2,41 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QFile>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // 进程内所有 DataManager 实例共享的 users.json 最新代次
+    // 用于发现其他实例做过整体保存：此时本实例基于旧代次的分片已不再生效
+    std::mutex g_generationMutex;
+    std::unordered_map<std::string, long long> g_latestUserGeneration;
+
+    long long latestUserGeneration(const std::string &path) {
+        std::lock_guard<std::mutex> lock(g_generationMutex);
+        auto it = g_latestUserGeneration.find(path);
+        return it != g_latestUserGeneration.end() ? it->second : 0;
+    }
+
+    void publishUserGeneration(const std::string &path, long long generation) {
+        std::lock_guard<std::mutex> lock(g_generationMutex);
+        long long &latest = g_latestUserGeneration[path];
+        latest = std::max(latest, generation);
+    }
+}
 
 // 构造函数，初始化时加载用户和商品数据
-DataManager::DataManager() {
+DataManager::DataManager() : persistenceOwner(PersistenceWorker::instance().newOwner()) {
     // 初始化时尝试加载数据
     loadUsersFromJson();
     loadProductsFromJson();
 }
 
 // 析构函数，销毁对象时不再自动保存，避免多个实例按退出顺序覆盖文件
-DataManager::~DataManager() {
-    // 不在析构中保存，统一由显式的 saveUsersToJson/saveProductsToJson 调用持久化
-}
+// 也不等待已提交的后台写入：临时实例随用随弃，不应阻塞界面线程；
+// 加载前会先等待写入完成，程序退出时由 main 统一等待
+DataManager::~DataManager() = default;
 
 /**
  * @brief 返回用户 JSON 文件的绝对路径
@@ -62,6 +85,27 @@ std::string DataManager::productFile() const {
     return parentBin.toStdString();
 }
 
+/**
+ * @brief 返回用户分片目录（与 users.json 同级的 users.d）
+ */
+std::string DataManager::userShardDir() const {
+    QFileInfo fi(QString::fromStdString(userFile()));
+    return QDir(fi.absolutePath()).filePath("users.d").toStdString();
+}
+
+/**
+ * @brief 返回指定代次、指定分片的文件路径，如 users.d/shard_3_07.json
+ *
+ * 代次写进文件名：整体保存后新旧代次的分片是不同的文件，
+ * 后台写入队列不会把新代次的分片合并到旧代次的写入中
+ */
+std::string DataManager::userShardFile(long long generation, uint32_t shard) const {
+    std::string index = std::to_string(shard);
+    if (index.size() < 2) index.insert(0, "0");
+    std::string name = "shard_" + std::to_string(generation) + "_" + index + ".json";
+    return QDir(QString::fromStdString(userShardDir())).filePath(QString::fromStdString(name)).toStdString();
+}
+
 // ============== 用户数据操作 ==============
 
 /**
@@ -83,6 +127,9 @@ bool DataManager::loadUsersFromJson() {
             return createEmptyJsonFile(path);
         }
 
+        // 先等待后台写入完成，保证读到其他实例已保存的最新数据
+        PersistenceWorker::instance().flush();
+
         // 打开用户数据文件
         std::ifstream file(path);
         if (!file.is_open()) {
@@ -95,6 +142,8 @@ bool DataManager::loadUsersFromJson() {
         file.close();
 
         users.clear(); // 清空当前用户列表
+        deltaUsers.clear();
+        dirtyShards.clear();
 
         // 把数据存到users容器
         if (j.contains("users") && j["users"].is_array()) {
@@ -103,7 +152,18 @@ bool DataManager::loadUsersFromJson() {
             }
         }
 
-        qDebug() << "成功加载 " << users.size() << " 个用户数据";
+        rebuildUserIndex();
+        fullSaveRequired = false;
+
+        // 叠加增量分片
+        userGeneration = 0;
+        if (j.contains("metadata") && j["metadata"].is_object()) {
+            userGeneration = j["metadata"].value("generation", 0LL);
+        }
+        publishUserGeneration(path, userGeneration);
+        loadUserShards();
+
+        qDebug() << "成功加载 " << users.size() << " 个用户数据（其中 " << deltaUsers.size() << " 个来自增量分片）";
         return true;
     }
     catch (const std::exception& e) {
@@ -113,56 +173,279 @@ bool DataManager::loadUsersFromJson() {
 }
 
 /**
- * @brief 保存用户数据到 JSON 文件
- * @return 保存成功返回 true，失败返回 false
+ * @brief 保存用户数据到 JSON 文件（整体保存）
+ * @return 成功提交到后台持久化线程返回 true，失败返回 false
  *
  * 保存流程：
- * 1. 将内存中的 UserData 对象序列化为 JSON
- * 2. 添加元数据（版本、更新时间、用户总数）
- * 3. 确保目标目录存在
- * 4. 格式化输出到文件
+ * 1. 在调用线程上拍下 users 的快照
+ * 2. 后台线程将快照序列化为 JSON，并添加元数据（版本、代次、更新时间、用户总数）
+ * 3. 以 临时文件 -> 刷盘 -> 重命名 的方式原子替换目标文件
+ *
+ * 整体保存会使代次加一，旧代次的增量分片随之失效，并在下次加载时被清理。
+ * 实际写入结果可通过 flush() 的返回值获得
  */
 bool DataManager::saveUsersToJson() {
     try {
-        const std::string path = userFile();
+        auto snapshot = std::make_shared<const std::vector<UserData> >(users);
+        return submitFullUserSave(snapshot->size(), [snapshot](json &usersArray) {
+            for (const auto& user : *snapshot) {
+                usersArray.push_back(userToJson(user));
+            }
+        });
+    } catch (const std::exception &e) {
+        qDebug() << "保存用户数据时发生错误: " << e.what();
+        return false;
+    }
+}
+
+/**
+ * @brief 整体保存外部提供的用户快照（写时复制的只读记录），不复制用户数据
+ * @param snapshot 用户快照，按原样写出
+ * @return 成功提交到后台持久化线程返回 true，失败返回 false
+ *
+ * 与 saveUsersToJson() 相同地推进代次；本实例内存中的 users 不随之改变
+ */
+bool DataManager::saveUserSnapshot(UserSnapshot snapshot) {
+    if (!snapshot) {
+        return false;
+    }
+    try {
+        const size_t count = snapshot->size();
+        return submitFullUserSave(count, [snapshot = std::move(snapshot)](json &usersArray) {
+            snapshot->forEach([&usersArray](const UserData &user) {
+                usersArray.push_back(userToJson(user));
+            });
+        });
+    } catch (const std::exception &e) {
+        qDebug() << "保存用户快照时发生错误: " << e.what();
+        return false;
+    }
+}
+
+/**
+ * @brief 提交一次整体保存：fillUsers 在后台线程中把快照中的用户写入 JSON 数组
+ */
+bool DataManager::submitFullUserSave(size_t count, std::function<void(json &)> fillUsers) {
+    const std::string path = userFile();
+    const long long generation = std::max(userGeneration, latestUserGeneration(path)) + 1;
+
+    PersistenceWorker::instance().submit(path, [fillUsers = std::move(fillUsers), count, generation]() {
         json j;
         json usersArray = json::array();
 
-        // 把users容器的数据序列化为json对象
-        for (const auto& user : users) {
-            usersArray.push_back(userToJson(user));
-        }
+        // 把快照中的数据序列化为json对象
+        fillUsers(usersArray);
 
         j["users"] = usersArray;
         std::time_t t = std::time(nullptr); // 获取当前时间
         j["metadata"] = {
             {"version", "1.0"},
+            {"generation", generation},
             {"lastUpdated", t},
-            {"totalUsers", users.size()}
+            {"totalUsers", count}
         };
 
-        // 确保目录存在
-        QFileInfo fi(QString::fromStdString(path));
-        QDir().mkpath(fi.absolutePath());
+        return j.dump(4); // 格式化输出，缩进4个空格
+    }, persistenceOwner);
 
-        // 打开文件进行写入
-        std::ofstream file(path);
-        if (!file.is_open()) {
-            std::cerr << "无法打开用户数据文件进行写入: " << path << std::endl;
-            return false;
+    userGeneration = generation;
+    publishUserGeneration(path, generation);
+    deltaUsers.clear();
+    dirtyShards.clear();
+    fullSaveRequired = false;
+
+    qDebug() << "已提交保存 " << count << " 个用户数据 => " << QString::fromStdString(path);
+    return true;
+}
+
+/**
+ * @brief 增量保存：只写入有变化用户所在的分片
+ * @return 成功提交到后台持久化线程返回 true，失败返回 false
+ *
+ * 每个分片文件保存"自上次整体保存以来变化过、且哈希到该分片的用户"，
+ * 因此修改单个用户只需重写一个分片，写入量与用户总数无关。
+ * 以下情况退回整体保存：
+ * - 用户数据被 replaceUsers() 整体替换过
+ * - 其他实例已做过整体保存（代次前进），本实例的分片不再生效
+ * - 变化过的用户过多，此时整体保存一次以压缩分片
+ */
+bool DataManager::saveDirtyUsers() {
+    if (fullSaveRequired) {
+        return saveUsersToJson();
+    }
+    if (dirtyShards.empty()) {
+        return true;
+    }
+
+    try {
+        const std::string path = userFile();
+        if (latestUserGeneration(path) != userGeneration) {
+            qDebug() << "用户数据已被其他实例整体保存，改为整体保存";
+            return saveUsersToJson();
+        }
+        if (deltaUsers.size() * 4 > users.size() + 256) {
+            return saveUsersToJson();
         }
 
-        file << j.dump(4); // 格式化输出，缩进4个空格
-        file.close();
+        // 按分片收集需要写入的用户：仍存在的写完整记录，已删除的写入 deleted 列表
+        struct ShardSnapshot {
+            std::vector<UserData> users;
+            std::vector<std::string> deleted;
+        };
+        std::unordered_map<uint32_t, ShardSnapshot> shards;
+        for (const auto& username : deltaUsers) {
+            uint32_t shard = userShardOf(username);
+            if (dirtyShards.count(shard) == 0) {
+                continue;
+            }
+
+            ShardSnapshot& snapshot = shards[shard];
+            if (UserData* user = findUser(username)) {
+                snapshot.users.push_back(*user);
+            } else {
+                snapshot.deleted.push_back(username);
+            }
+        }
+
+        const long long generation = userGeneration;
+        for (auto& entry : shards) {
+            const uint32_t shard = entry.first;
+            auto snapshot = std::make_shared<const ShardSnapshot>(std::move(entry.second));
+
+            PersistenceWorker::instance().submit(userShardFile(generation, shard), [snapshot, generation, shard]() {
+                json usersArray = json::array();
+                for (const auto& user : snapshot->users) {
+                    usersArray.push_back(userToJson(user));
+                }
+
+                json j;
+                j["users"] = usersArray;
+                j["deleted"] = snapshot->deleted;
+                std::time_t t = std::time(nullptr); // 获取当前时间
+                j["metadata"] = {
+                    {"version", "1.0"},
+                    {"generation", generation},
+                    {"shard", shard},
+                    {"lastUpdated", t}
+                };
+
+                return j.dump(4);
+            }, persistenceOwner);
+        }
 
-        qDebug() << "成功保存 " << users.size() << " 个用户数据 => " << QString::fromStdString(path);
+        qDebug() << "已提交增量保存 " << shards.size() << " 个用户分片";
+        dirtyShards.clear();
         return true;
     } catch (const std::exception &e) {
-        qDebug() << "保存用户数据时发生错误: " << e.what();
+        qDebug() << "增量保存用户数据时发生错误: " << e.what();
         return false;
     }
 }
 
+/**
+ * @brief 标记用户已变化，下次 saveDirtyUsers() 时写入其所在分片
+ * @param username 用户名（已删除的用户同样需要标记）
+ */
+void DataManager::markUserDirty(const std::string &username) {
+    deltaUsers.insert(username);
+    dirtyShards.insert(userShardOf(username));
+}
+
+/**
+ * @brief 计算用户所在的分片
+ *
+ * 使用 FNV-1a 而不是 std::hash：分片归属会写入磁盘，必须跨平台、跨版本稳定
+ */
+uint32_t DataManager::userShardOf(const std::string &username) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : username) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash % kUserShardCount;
+}
+
+/**
+ * @brief 将 users.d 下与当前代次一致的分片叠加到 users 上
+ *
+ * 分片中的用户记录覆盖基础快照中的同名用户，deleted 列表中的用户被移除。
+ * 代次低于 users.json 的分片来自更早的整体保存，已包含在其中，直接删除；
+ * 代次更高的分片说明那次整体保存没有写成功（写入失败或中途崩溃），分片之后的修改只保存在这些分片中：
+ * 按代次从低到高叠加在当前代次的分片之后，并要求下次保存时整体保存，用更高的代次把它们合并进 users.json
+ */
+void DataManager::loadUserShards() {
+    QDir dir(QString::fromStdString(userShardDir()));
+    if (!dir.exists()) {
+        return;
+    }
+
+    // 文件名为 shard_<代次>_<分片号>.json，按代次排序，同一代次内按文件名
+    std::vector<std::pair<long long, QString> > shardFiles;
+    long long newestGeneration = userGeneration;
+    const QStringList files = dir.entryList(QStringList{"shard_*.json"}, QDir::Files);
+    for (const QString& name : files) {
+        const std::string fileName = name.toStdString();
+        long long generation = -1;
+        try {
+            generation = std::stoll(fileName.substr(6, fileName.find('_', 6) - 6));
+        } catch (const std::exception &) {
+        }
+        if (generation < userGeneration) {
+            QFile::remove(dir.filePath(name));
+            continue;
+        }
+        newestGeneration = std::max(newestGeneration, generation);
+        shardFiles.emplace_back(generation, name);
+    }
+    std::stable_sort(shardFiles.begin(), shardFiles.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    if (newestGeneration > userGeneration) {
+        qDebug() << "发现未完成整体保存之后的用户分片，下次保存时整体保存";
+        userGeneration = newestGeneration;
+        publishUserGeneration(userFile(), userGeneration);
+        fullSaveRequired = true;
+    }
+
+    for (const auto& [generation, name] : shardFiles) {
+        try {
+            std::ifstream file(dir.filePath(name).toStdString());
+            if (!file.is_open()) {
+                continue;
+            }
+
+            json j;
+            file >> j;
+
+            if (j.contains("users") && j["users"].is_array()) {
+                for (const auto& userJson : j["users"]) {
+                    UserData user = jsonToUser(userJson);
+                    deltaUsers.insert(user.username);
+
+                    UserData* existing = findUser(user.username);
+                    if (existing) {
+                        *existing = std::move(user);
+                    } else {
+                        appendUser(std::move(user));
+                    }
+                }
+            }
+
+            if (j.contains("deleted") && j["deleted"].is_array()) {
+                for (const auto& nameJson : j["deleted"]) {
+                    const std::string username = nameJson.get<std::string>();
+                    deltaUsers.insert(username);
+                    if (UserData* user = findUser(username)) {
+                        eraseUserAt(static_cast<size_t>(user - users.data()));
+                    }
+                }
+            }
+        } catch (const std::exception &e) {
+            qDebug() << "加载用户分片时发生错误: " << name << e.what();
+        }
+    }
+}
+
 /**
  * @brief 添加新用户到系统
  * @param user 要添加的用户数据
@@ -175,20 +458,19 @@ bool DataManager::addUser(const UserData& user) {
         return false;
     }
 
-    users.push_back(user);
+    appendUser(user);
+    markUserDirty(user.username);
     qDebug() << "成功添加用户: " << user.username;
     return true;
 }
 
 // 删除用户
 bool DataManager::removeUser(const std::string &username) {
-    auto it = std::find_if(users.begin(), users.end(),
-                           [&username](const UserData &user) {
-                               return user.username == username;
-                           });
+    UserData* user = findUser(username);
 
-    if (it != users.end()) {
-        users.erase(it);
+    if (user != nullptr) {
+        eraseUserAt(static_cast<size_t>(user - users.data()));
+        markUserDirty(username);
         qDebug() << "成功删除用户: " << username;
         return true;
     }
@@ -197,14 +479,29 @@ bool DataManager::removeUser(const std::string &username) {
     return false;
 }
 
-// 查找用户
+/**
+ * @brief 按用户名查找用户（哈希索引，O(1)）
+ * @param username 用户名
+ * @return 找到返回用户指针，未找到返回 nullptr
+ *
+ * getUsers() 返回的容器可能被外部直接修改：发现容器大小与建索引时不同，
+ * 或索引指向的记录用户名不符时，重建索引后再查
+ */
 UserData *DataManager::findUser(const std::string &username) {
-    auto it = std::find_if(users.begin(), users.end(),
-        [&username](const UserData& user) {
-            return user.username == username;
-        });
+    if (indexedUserCount != users.size()) {
+        rebuildUserIndex();
+    }
 
-    return (it != users.end()) ? &(*it) : nullptr;
+    const size_t* slot = userIndex.find(username);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    if (*slot >= users.size() || users[*slot].username != username) {
+        rebuildUserIndex();
+        slot = userIndex.find(username);
+        return slot ? &users[*slot] : nullptr;
+    }
+    return &users[*slot];
 }
 
 /**
@@ -215,6 +512,19 @@ std::vector<UserData>& DataManager::getUsers() {
     return users;
 }
 
+/**
+ * @brief 整体替换用户数据
+ * @param newUsers 新的用户数据
+ *
+ * 只重建一次索引，避免逐个 addUser 时每次查重的开销；
+ * 替换后无法区分哪些用户发生了变化，下次保存时退回整体保存
+ */
+void DataManager::replaceUsers(std::vector<UserData> newUsers) {
+    users = std::move(newUsers);
+    rebuildUserIndex();
+    fullSaveRequired = true;
+}
+
 // ============== 商品数据操作 ==============
 
 /**
@@ -232,6 +542,9 @@ bool DataManager::loadProductsFromJson() {
             return createEmptyJsonFile(path);
         }
 
+        // 先等待后台写入完成，保证读到其他实例已保存的最新数据
+        PersistenceWorker::instance().flush();
+
         // 打开商品数据文件
         std::ifstream file(path);
         if (!file.is_open()) {
@@ -251,6 +564,7 @@ bool DataManager::loadProductsFromJson() {
                 products.push_back(jsonToProduct(productJson));
             }
         }
+        rebuildProductIndex();
 
         qDebug() << "成功加载 " << products.size() << " 个商品数据";
         return true;
@@ -262,42 +576,36 @@ bool DataManager::loadProductsFromJson() {
 
 /**
  * @brief 保存商品数据到 JSON 文件
- * @return 保存成功返回 true，失败返回 false
+ * @return 成功提交到后台持久化线程返回 true，失败返回 false
+ *
+ * 与 saveUsersToJson() 相同：快照在调用线程拍下，序列化与原子写入在后台完成
  */
 bool DataManager::saveProductsToJson() {
     try {
         const std::string path = productFile();
-        json j;
-        json productsArray = json::array();
+        auto snapshot = std::make_shared<const std::vector<ProductData> >(products);
 
-        // JSON 结构序列化逻辑
-        for (const auto& product : products) {
-            productsArray.push_back(productToJson(product));
-        }
+        PersistenceWorker::instance().submit(path, [snapshot]() {
+            json j;
+            json productsArray = json::array();
 
-        j["products"] = productsArray;
-        std::time_t t = std::time(nullptr); // 获取当前时间
-        j["metadata"] = {
-            {"version", "1.0"},
-            {"lastUpdated", t},
-            {"totalProducts", products.size()}
-        };
-
-        // 确保目录存在
-        QFileInfo fi(QString::fromStdString(path));
-        QDir().mkpath(fi.absolutePath());
+            // JSON 结构序列化逻辑
+            for (const auto& product : *snapshot) {
+                productsArray.push_back(productToJson(product));
+            }
 
-        // 打开文件进行写入
-        std::ofstream file(path);
-        if (!file.is_open()) {
-            std::cerr << "无法打开商品数据文件进行写入: " << path << std::endl;
-            return false;
-        }
+            j["products"] = productsArray;
+            std::time_t t = std::time(nullptr); // 获取当前时间
+            j["metadata"] = {
+                {"version", "1.0"},
+                {"lastUpdated", t},
+                {"totalProducts", snapshot->size()}
+            };
 
-        file << j.dump(4); // 格式化输出，缩进4个空格
-        file.close();
+            return j.dump(4); // 格式化输出，缩进4个空格
+        }, persistenceOwner);
 
-        qDebug() << "成功保存 " << products.size() << " 个商品数据 => " << QString::fromStdString(path);
+        qDebug() << "已提交保存 " << products.size() << " 个商品数据 => " << QString::fromStdString(path);
         return true;
     } catch (const std::exception &e) {
         qDebug() << "保存商品数据时发生错误: " << e.what();
@@ -313,19 +621,46 @@ bool DataManager::addProduct(const ProductData &product) {
     }
 
     products.push_back(product);
-    qDebug() << "成功添加商品: " << product.name << " (ID: " << product.productId << ")";
+    productIndex.insert(product.productId, products.size() - 1);
+    indexedProductCount = products.size();
+    // 查询索引尚未建立时不必维护，第一次查询时连同新商品一起建立
+    if (queryIndexesBuilt) {
+        if (searchIndex.size() == products.size() - 1) {
+            searchIndex.addProduct(products.size() - 1, product);
+        } else {
+            searchIndex.build(products);
+        }
+        if (autocomplete.productCount() == products.size() - 1) {
+            autocomplete.addProduct(product);
+        } else {
+            autocomplete.build(products);
+        }
+        if (facetIndex.size() == products.size() - 1) {
+            facetIndex.addProduct(products.size() - 1, product);
+        } else {
+            facetIndex.build(products);
+        }
+        if (sortedIndex.size() == products.size() - 1) {
+            sortedIndex.addProduct(products.size() - 1, product);
+        } else {
+            sortedIndex.build(products);
+        }
+        if (stockLedger.size() == products.size() - 1) {
+            stockLedger.addProduct(products.size() - 1, product.stock);
+        } else {
+            stockLedger.build(products);
+        }
+    }
+    qDebug() << "成功添加商品: " << product.name.toQString() << " (ID: " << product.productId << ")";
     return true;
 }
 
 bool DataManager::removeProduct(int productId) {
-    auto it = std::find_if(products.begin(), products.end(),
-                           [productId](const ProductData &product) {
-                               return product.productId == productId;
-                           });
-
-    if (it != products.end()) {
-        qDebug() << "成功删除商品: " << it->name << " (ID: " << productId << ")";
-        products.erase(it);
+    ProductData* product = findProduct(productId);
+
+    if (product != nullptr) {
+        qDebug() << "成功删除商品: " << product->name.toQString() << " (ID: " << productId << ")";
+        eraseProductAt(static_cast<size_t>(product - products.data()));
         return true;
     }
 
@@ -334,17 +669,27 @@ bool DataManager::removeProduct(int productId) {
 }
 
 /**
- * @brief 根据商品ID查找商品
+ * @brief 根据商品ID查找商品（哈希索引，O(1)）
  * @param productId 要查找的商品ID
  * @return 找到返回商品指针，未找到返回 nullptr
+ *
+ * 与 findUser() 相同，发现 products 被外部直接修改时重建索引
  */
 ProductData* DataManager::findProduct(int productId) {
-    auto it = std::find_if(products.begin(), products.end(),
-        [productId](const ProductData& product) {
-            return product.productId == productId;
-        });
+    if (indexedProductCount != products.size()) {
+        rebuildProductIndex();
+    }
 
-    return (it != products.end()) ? &(*it) : nullptr;
+    const size_t* slot = productIndex.find(productId);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    if (*slot >= products.size() || products[*slot].productId != productId) {
+        rebuildProductIndex();
+        slot = productIndex.find(productId);
+        return slot ? &products[*slot] : nullptr;
+    }
+    return &products[*slot];
 }
 
 /**
@@ -355,61 +700,131 @@ std::vector<ProductData>& DataManager::getProducts() {
     return products;
 }
 
+// ============== 持久化 ==============
+
+/**
+ * @brief 等待已提交的后台写入全部完成
+ * @return 此前提交的写入全部成功返回 true
+ */
+bool DataManager::flush() {
+    // 写入失败时磁盘上的用户数据可能缺少已清除脏标记的修改，下次保存退回整体保存
+    const bool ok = PersistenceWorker::instance().flush(persistenceOwner);
+    if (!ok) {
+        fullSaveRequired = true;
+    }
+    return ok;
+}
+
+/**
+ * @brief 获取后台持久化的队列深度与写入耗时等指标
+ */
+PersistenceMetrics DataManager::persistenceMetrics() const {
+    return PersistenceWorker::instance().metrics();
+}
+
 // ============== 商品筛选与搜索功能 ==============
 
 /**
  * @brief 根据关键词搜索商品
- * @param keyword 搜索关键词（不区分大小写）
- * @return 匹配的商品列表
+ * @param keyword 搜索关键词（不区分大小写，全角字母数字按半角处理）
+ * @return 匹配的商品下标，按相关度排序
  *
  * 搜索范围：商品名称和分类
- * 空关键词返回所有商品
+ * 空关键词返回所有商品（不复制、不分配下标列表）
+ * 通过 n-gram 倒排索引只核对候选商品，不再逐个扫描全部商品；
+ * 索引在第一次查询时建立，products 被外部直接增删时重建
  */
-std::vector<ProductData> DataManager::searchProducts(const std::string& keyword) const {
-    std::vector<ProductData> results;
-
+ProductResultSet DataManager::searchProducts(const std::string& keyword) {
     if (keyword.empty()) {
-        return products; // 如果没有关键词，返回所有商品
+        return ProductResultSet::all(products); // 如果没有关键词，返回所有商品
     }
 
-    std::string lowercaseKeyword = toLowercase(keyword);
-
-    // 在商品名称和分类中搜索关键词
-    for (const auto& product : products) {
-        if (containsKeyword(product.name, lowercaseKeyword) ||
-            containsKeyword(product.category, lowercaseKeyword)) {
-            results.push_back(product);
-        }
-    }
+    ensureQueryIndexes();
+    std::vector<size_t> matched = searchIndex.search(keyword, products);
 
-    qDebug() << "关键词搜索 '" << QString::fromStdString(keyword) << "' 找到 " << results.size() << " 个商品";
-    return results;
+    qDebug() << "关键词搜索 '" << QString::fromStdString(keyword) << "' 找到 " << matched.size() << " 个商品";
+    return ProductResultSet::own(products, std::move(matched));
 }
 
 /**
  * @brief 按分类筛选商品
  * @param category 商品分类
- * @return 指定分类的商品列表
+ * @return 指定分类的商品下标
  *
  * 空分类或"全部"返回所有商品
+ * 直接引用分类倒排表，不复制
  */
-std::vector<ProductData> DataManager::filterByCategory(const std::string& category) const {
-    std::vector<ProductData> results;
-
+ProductResultSet DataManager::filterByCategory(const std::string& category) {
     if (category.empty() || category == "全部") {
-        return products; // 如果没有指定分类或选择全部，返回所有商品
+        return ProductResultSet::all(products); // 如果没有指定分类或选择全部，返回所有商品
     }
 
-    for (const auto& product : products) {
-        if (product.category == category) {
-            results.push_back(product);
-        }
-    }
+    ensureQueryIndexes();
+    static const std::vector<uint32_t> none;
+    const std::vector<uint32_t>* members = facetIndex.categorySlots(category);
+    ProductResultSet results = ProductResultSet::borrow(products, members ? *members : none);
 
     qDebug() << "分类筛选 '" << QString::fromStdString(category) << "' 找到 " << results.size() << " 个商品";
     return results;
 }
 
+/**
+ * @brief 组合筛选商品
+ * @param query 筛选条件：关键词、分类、价格区间、是否只看有库存
+ * @return 命中的商品下标（有关键词时按相关度排序）以及各分面的计数
+ *
+ * 关键词经 n-gram 索引得到候选，与分类倒排表、价格和库存条件按位图求交集，
+ * 结果与分类计数、库存计数、价格范围在同一遍扫描中得到
+ */
+ProductQueryResult DataManager::queryProducts(const ProductQuery& query) {
+    ensureQueryIndexes();
+
+    if (query.keyword.empty()) {
+        return facetIndex.query(query, nullptr);
+    }
+    const std::vector<size_t> ranked = searchIndex.search(query.keyword, products);
+    return facetIndex.query(query, &ranked);
+}
+
+/**
+ * @brief 范围 + 排序 + 分页查询商品
+ * @param query 范围字段与上下限、排序字段与方向、offset/limit
+ * @return 本页商品下标与满足范围条件的总数
+ *
+ * 范围字段与排序字段相同时代价为 O(log P + 页大小)
+ */
+ProductPage DataManager::queryProductRange(const ProductRangeQuery& query) {
+    ensureQueryIndexes();
+    return sortedIndex.query(query);
+}
+
+/**
+ * @brief 把查询结果按字段排列
+ * @param matches 商品下标（如 queryProducts 的结果），原地排列
+ * @param key 排序字段
+ * @param descending 是否降序；同值的商品总按下标升序
+ *
+ * 由有序索引完成，结果较多时顺序遍历索引，不再逐次比较商品数据
+ */
+void DataManager::sortProducts(std::vector<size_t>& matches, ProductSortKey key, bool descending) {
+    ensureQueryIndexes();
+    sortedIndex.order(matches, key, descending);
+}
+
+/**
+ * @brief 商品名称/分类的前缀补全
+ * @param prefix 已输入的文本（不区分大小写）
+ * @param limit 最多返回的条数
+ * @return 补全建议，按热度（评价人数）与平均评分排序
+ *
+ * 前缀树在第一次查询时建立，之后随增删商品和评分变化增量更新；
+ * 发现 products 被外部直接增删时整体重建
+ */
+std::vector<ProductCompletion> DataManager::completeProducts(const std::string& prefix, size_t limit) {
+    ensureQueryIndexes();
+    return autocomplete.complete(prefix, limit);
+}
+
 /**
  * @brief 获取用户购物车的详细信息
  * @param username 用户名
@@ -432,14 +847,11 @@ getShoppingCartDetails(const std::string& username, double& totalPrice, int& tot
         return items;
     }
 
-    // 遍历购物车中的每一项 [商品ID, 数量]
+    // 遍历购物车中的每一项 {商品ID, 数量}
+    items.reserve(user->shoppingCart.size());
     for (const auto& entry : user->shoppingCart) {
-        if (entry.size() < 2) {
-            continue; // 跳过格式不正确的项
-        }
-
-        int productId = entry[0];
-        int quantity = entry[1];
+        int productId = entry.productId;
+        int quantity = entry.value;
         if (quantity <= 0) {
             continue; // 跳过无效数量
         }
@@ -484,6 +896,7 @@ getShoppingCartDetails(const std::string& username, double& totalPrice, int& tot
  * 否则添加新的购物车项
  */
 bool DataManager::addToCart(const std::string& username, int productId, int quantity) {
+    std::lock_guard<std::mutex> lock(checkoutMutex); // 与结算读写购物车互斥
     UserData* user = findUser(username);
     if (!user) {
         qDebug() << "未找到用户:" << QString::fromStdString(username);
@@ -491,30 +904,32 @@ bool DataManager::addToCart(const std::string& username, int productId, int quan
     }
 
     // 检查商品是否存在
-    if (!findProduct(productId)) {
+    ProductData* product = findProduct(productId);
+    if (!product) {
         qDebug() << "商品不存在，ID:" << productId;
         return false;
     }
 
-    // 检查购物车中是否已有该商品
-    bool found = false;
-    for (auto& entry : user->shoppingCart) {
-        if (entry.size() >= 2 && entry[0] == productId) {
-            entry[1] += quantity; // 累加数量
-            found = true;
-            qDebug() << "更新购物车商品数量，用户:" << QString::fromStdString(username)
-                << "商品ID:" << productId << "新数量:" << entry[1];
-            break;
-        }
+    // 累加后的数量不能超过可用库存
+    const int stock = availableStock(static_cast<size_t>(product - products.data()));
+    if (user->shoppingCart.valueOf(productId, 0) + quantity > stock) {
+        qDebug() << "库存不足，商品ID:" << productId << "可用库存:" << stock;
+        return false;
     }
 
-    if (!found) {
-        // 添加新商品到购物车
-        user->shoppingCart.push_back({ productId, quantity });
+    // 已在购物车中则累加数量，否则添加新商品
+    if (user->shoppingCart.contains(productId)) {
+        int newQuantity = user->shoppingCart.add(productId, quantity);
+        qDebug() << "更新购物车商品数量，用户:" << QString::fromStdString(username)
+            << "商品ID:" << productId << "新数量:" << newQuantity;
+    }
+    else {
+        user->shoppingCart.set(productId, quantity);
         qDebug() << "添加商品到购物车，用户:" << QString::fromStdString(username)
             << "商品ID:" << productId << "数量:" << quantity;
     }
 
+    markUserDirty(username);
     return true;
 }
 
@@ -525,13 +940,15 @@ bool DataManager::addToCart(const std::string& username, int productId, int quan
  * @return 操作成功返回 true
  */
 bool DataManager::removeFromCart(const std::string& username, int productId) {
+    std::lock_guard<std::mutex> lock(checkoutMutex); // 与结算读写购物车互斥
     UserData* user = findUser(username);
     if (!user) {
         qDebug() << "未找到用户:" << QString::fromStdString(username);
         return false;
     }
 
-    if (removeItemFromVector(user->shoppingCart, productId)) {
+    if (user->shoppingCart.erase(productId)) {
+        markUserDirty(username);
         qDebug() << "从购物车移除商品，用户:" << QString::fromStdString(username) << "商品ID:" << productId;
         return true;
     }
@@ -552,6 +969,7 @@ bool DataManager::updateCartQuantity(const std::string& username, int productId,
         return removeFromCart(username, productId);
     }
 
+    std::lock_guard<std::mutex> lock(checkoutMutex); // 与结算读写购物车互斥
     UserData* user = findUser(username);
     if (!user) {
         qDebug() << "未找到用户:" << QString::fromStdString(username);
@@ -559,24 +977,315 @@ bool DataManager::updateCartQuantity(const std::string& username, int productId,
     }
 
     // 检查商品是否存在
-    if (!findProduct(productId)) {
+    ProductData* product = findProduct(productId);
+    if (!product) {
         qDebug() << "商品不存在，ID:" << productId;
         return false;
     }
 
-    // 直接设置新数量（不累加）
-    if (updateItemInVector(user->shoppingCart, productId, newQuantity)) {
+    // 增加数量时不能超过可用库存（减少数量总是允许）
+    const int stock = availableStock(static_cast<size_t>(product - products.data()));
+    if (newQuantity > stock && newQuantity > user->shoppingCart.valueOf(productId, 0)) {
+        qDebug() << "库存不足，商品ID:" << productId << "可用库存:" << stock;
+        return false;
+    }
+
+    markUserDirty(username);
+
+    // 直接设置新数量（不累加）；商品不在购物车中时添加新商品
+    if (!user->shoppingCart.set(productId, newQuantity)) {
         qDebug() << "更新购物车商品数量（直接设置），用户:" << QString::fromStdString(username)
             << "商品ID:" << productId << "数量:" << newQuantity;
-        return true;
     }
     else {
-        // 如果商品不在购物车中，添加新商品
-        user->shoppingCart.push_back({ productId, newQuantity });
         qDebug() << "添加商品到购物车（通过更新数量），用户:" << QString::fromStdString(username)
             << "商品ID:" << productId << "数量:" << newQuantity;
-        return true;
     }
+    return true;
+}
+
+// 一批一起落盘的结算：各项已在内存中扣减库存、移出购物车，落盘失败时整批回滚
+struct CheckoutBatch {
+    struct Line {
+        size_t slot;
+        int productId;
+        int quantity;
+    };
+    struct Entry {
+        std::string username;
+        std::vector<Line> lines;
+    };
+
+    std::vector<Entry> entries;
+    bool submitted = false; // 已提交保存，之后的结算加入下一批
+    bool saved = false;     // 两个文件都已成功提交
+    bool finished = false;  // 已确认或已回滚
+    bool durable = false;   // 落盘成功
+};
+
+/**
+ * @brief 结算：为购物车中的全部商品预留库存，全部成功后扣减库存、移出购物车并保存
+ * @param username 用户名
+ * @param result 输出结算结果；失败时 failedProductId / availableStock / message 说明原因
+ * @return 结算成功返回 true；失败时库存与购物车保持不变
+ *
+ * 在内存中完成结算（见 stageCheckout）并加入当前批次后即释放 checkoutMutex，再等待落盘：
+ * 同一时刻只有一批在等待落盘，排队期间加入的结算由排在最前的线程一次提交保存、一次等待，
+ * 其余线程醒来时发现本批已完成便直接返回；落盘失败时整批回滚
+ */
+bool DataManager::checkout(const std::string& username, CheckoutResult& result) {
+    const CheckoutTicket batch = stageCheckout(username, result);
+    if (!batch) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> commitLock(commitMutex);
+    bool pending;
+    {
+        std::lock_guard<std::mutex> lock(checkoutMutex);
+        pending = !batch->finished;
+        if (pending && !batch->submitted) {
+            submitCheckouts(*batch);
+        }
+    }
+    if (pending) {
+        const bool flushed = PersistenceWorker::instance().flush(persistenceOwner);
+        std::lock_guard<std::mutex> lock(checkoutMutex);
+        finishCheckouts(*batch, flushed);
+    }
+
+    std::lock_guard<std::mutex> lock(checkoutMutex);
+    if (!batch->durable) {
+        result = CheckoutResult{};
+        result.message = "保存失败";
+        return false;
+    }
+    qDebug() << "结算成功，用户:" << QString::fromStdString(username)
+        << "商品数量:" << result.totalQuantity << "总金额:" << result.totalPrice;
+    return true;
+}
+
+/**
+ * @brief 分步结算的第一步：在内存中完成结算并立即提交保存，不等待落盘
+ * @return 等待落盘确认的票据；结算失败（库存不足等）返回空票据，此时库存与购物车保持不变
+ */
+CheckoutTicket DataManager::beginCheckout(const std::string& username, CheckoutResult& result) {
+    CheckoutTicket batch = stageCheckout(username, result);
+    if (batch) {
+        std::lock_guard<std::mutex> lock(checkoutMutex);
+        if (!batch->submitted) {
+            submitCheckouts(*batch);
+        }
+    }
+    return batch;
+}
+
+/**
+ * @brief 分步结算的第二步：等待本批结算落盘，返回写入是否全部成功
+ *
+ * 只访问后台持久化线程，不读写本实例的数据，可在其他线程中调用
+ */
+bool DataManager::waitForCheckout(const CheckoutTicket& ticket) {
+    return ticket != nullptr && PersistenceWorker::instance().flush(persistenceOwner);
+}
+
+/**
+ * @brief 分步结算的第三步：按 waitForCheckout 的结果确认结算，落盘失败时回滚本批
+ * @return 结算最终成功返回 true；失败时 result 只保留失败原因
+ */
+bool DataManager::endCheckout(const CheckoutTicket& ticket, bool durable, CheckoutResult& result) {
+    if (!ticket) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(checkoutMutex);
+    finishCheckouts(*ticket, durable);
+    if (!ticket->durable) {
+        result = CheckoutResult{};
+        result.message = "保存失败";
+        return false;
+    }
+    qDebug() << "结算成功，商品数量:" << result.totalQuantity << "总金额:" << result.totalPrice;
+    return true;
+}
+
+/**
+ * @brief 在内存中完成结算，并把它加入尚未提交保存的批次
+ * @return 加入的批次；失败时返回空，库存与购物车保持不变
+ *
+ * 分三步：
+ * 1. 在 checkoutMutex 下读取购物车、把商品ID换成下标，并登记该用户正在结算
+ * 2. 不持锁，按购物车顺序逐个在库存计数上预留；某个商品不足时归还已预留的部分
+ * 3. 在 checkoutMutex 下把预留写回商品库存、更新分面与有序索引、移出购物车
+ * 不同用户的结算可以并发，预留不持锁，第 1、3 步互斥；库存计数保证任何时刻都不会超卖
+ */
+CheckoutTicket DataManager::stageCheckout(const std::string& username, CheckoutResult& result) {
+    result = CheckoutResult{};
+    std::vector<CheckoutBatch::Line> lines;
+
+    {
+        std::lock_guard<std::mutex> lock(checkoutMutex);
+        ensureQueryIndexes(); // 预留依赖库存计数，写回依赖分面与有序索引
+        UserData* user = findUser(username);
+        if (!user) {
+            qDebug() << "未找到用户:" << QString::fromStdString(username);
+            result.message = "未找到用户";
+            return nullptr;
+        }
+        if (!checkoutUsers.insert(username).second) {
+            qDebug() << "用户正在结算:" << QString::fromStdString(username);
+            result.message = "正在结算中";
+            return nullptr;
+        }
+
+        lines.reserve(user->shoppingCart.size());
+        result.items.reserve(user->shoppingCart.size());
+        for (const auto& entry : user->shoppingCart) {
+            if (entry.value <= 0) {
+                continue;
+            }
+            ProductData* product = findProduct(entry.productId);
+            if (!product) {
+                qDebug() << "结算失败，商品不存在，ID:" << entry.productId;
+                checkoutUsers.erase(username);
+                result = CheckoutResult{};
+                result.failedProductId = entry.productId;
+                result.message = "商品不存在";
+                return nullptr;
+            }
+
+            const size_t slot = static_cast<size_t>(product - products.data());
+            lines.push_back(CheckoutBatch::Line{slot, entry.productId, entry.value});
+
+            CartItemDetails item{};
+            item.productId = entry.productId;
+            item.name = product->name;
+            item.quantity = entry.value;
+            item.unitPrice = product->price;
+            item.subtotal = item.unitPrice * static_cast<double>(item.quantity);
+            result.totalPrice += item.subtotal;
+            result.totalQuantity += item.quantity;
+            result.items.push_back(std::move(item));
+        }
+
+        if (lines.empty()) {
+            checkoutUsers.erase(username);
+            result.message = "购物车为空";
+            return nullptr;
+        }
+    }
+
+    // 预留库存：不持锁，只在同一商品的计数上竞争
+    size_t reserved = 0;
+    while (reserved < lines.size() && stockLedger.tryReserve(lines[reserved].slot, lines[reserved].quantity)) {
+        reserved++;
+    }
+
+    std::lock_guard<std::mutex> lock(checkoutMutex);
+    checkoutUsers.erase(username);
+
+    if (reserved < lines.size()) {
+        for (size_t i = 0; i < reserved; i++) {
+            stockLedger.release(lines[i].slot, lines[i].quantity);
+        }
+        const CheckoutBatch::Line& failed = lines[reserved];
+        const std::string name = result.items[reserved].name;
+        result = CheckoutResult{};
+        result.failedProductId = failed.productId;
+        result.availableStock = stockLedger.available(failed.slot);
+        result.message = "库存不足: " + name;
+        qDebug() << "结算失败，库存不足，商品ID:" << failed.productId
+            << "需要:" << failed.quantity << "可用:" << result.availableStock;
+        return nullptr;
+    }
+
+    UserData* user = findUser(username);
+    if (!user) {
+        for (const CheckoutBatch::Line& line : lines) {
+            stockLedger.release(line.slot, line.quantity);
+        }
+        result = CheckoutResult{};
+        result.message = "未找到用户";
+        return nullptr;
+    }
+
+    // 预留写回商品库存；结算期间用户又加购的数量保留在购物车中
+    for (const CheckoutBatch::Line& line : lines) {
+        ProductData& product = products[line.slot];
+        product.stock -= line.quantity;
+        facetIndex.updateProduct(line.slot, product);
+        sortedIndex.updateProduct(line.slot, product);
+
+        const int remaining = user->shoppingCart.valueOf(line.productId, 0) - line.quantity;
+        if (remaining > 0) {
+            user->shoppingCart.set(line.productId, remaining);
+        } else {
+            user->shoppingCart.erase(line.productId);
+        }
+    }
+    markUserDirty(username);
+
+    if (!openBatch) {
+        openBatch = std::make_shared<CheckoutBatch>();
+    }
+    openBatch->entries.push_back(CheckoutBatch::Entry{username, std::move(lines)});
+    return openBatch;
+}
+
+/**
+ * @brief 把商品与用户一并提交保存，此后新的结算加入下一批；调用方须持有 checkoutMutex
+ *
+ * 保存时拍下的快照包含此前在内存中完成的全部结算
+ */
+bool DataManager::submitCheckouts(CheckoutBatch& batch) {
+    if (openBatch.get() == &batch) {
+        openBatch.reset();
+    }
+    batch.submitted = true;
+    batch.saved = saveProductsToJson() && saveDirtyUsers();
+    return batch.saved;
+}
+
+/**
+ * @brief 按落盘结果确认一批结算，失败时整批回滚；调用方须持有 checkoutMutex
+ *
+ * 回滚恢复库存、索引与购物车，并按恢复后的数据重新提交两个文件（可能只有一个文件写入失败，
+ * 另一个已写入扣减后的数据）；重新提交不等待落盘，其结果由下一次 flush 报告
+ */
+void DataManager::finishCheckouts(CheckoutBatch& batch, bool durable) {
+    if (batch.finished) {
+        return;
+    }
+    batch.finished = true;
+    batch.durable = durable && batch.saved;
+    if (batch.durable) {
+        qDebug() << "结算已落盘，本批" << batch.entries.size() << "笔";
+        return;
+    }
+
+    // 写入失败时磁盘上的用户数据可能缺少已清除脏标记的修改，与 flush() 相同地退回整体保存
+    fullSaveRequired = true;
+    for (const CheckoutBatch::Entry& entry : batch.entries) {
+        UserData* user = findUser(entry.username);
+        for (const CheckoutBatch::Line& line : entry.lines) {
+            // 等待落盘期间商品被重新加载过时，内存中已是文件里的库存，不再恢复
+            if (line.slot < products.size() && products[line.slot].productId == line.productId) {
+                ProductData& product = products[line.slot];
+                product.stock += line.quantity;
+                stockLedger.release(line.slot, line.quantity);
+                facetIndex.updateProduct(line.slot, product);
+                sortedIndex.updateProduct(line.slot, product);
+            }
+            if (user) {
+                user->shoppingCart.add(line.productId, line.quantity);
+            }
+        }
+        if (user) {
+            markUserDirty(entry.username);
+        }
+    }
+    saveProductsToJson();
+    saveDirtyUsers();
+    qDebug() << "结算保存失败，已回滚本批" << batch.entries.size() << "笔";
 }
 
 /**
@@ -601,21 +1310,10 @@ bool DataManager::addViewHistory(const std::string& username, int productId) {
         return false;
     }
 
-    // 查找是否已有浏览记录
-    bool found = false;
-    for (auto& entry : user->viewHistory) {
-        if (entry.size() >= 2 && entry[0] == productId) {
-            entry[1]++; // 增加浏览次数
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
-        // 添加新的浏览记录
-        user->viewHistory.push_back({ productId, 1 });
-    }
+    // 已有浏览记录则增加浏览次数，否则添加新的浏览记录
+    user->viewHistory.add(productId, 1);
 
+    markUserDirty(username);
     qDebug() << "添加浏览历史，用户:" << QString::fromStdString(username) << "商品ID:" << productId;
     return true;
 }
@@ -646,16 +1344,15 @@ bool DataManager::addToFavorites(const std::string& username, int productId, int
         return false;
     }
 
-    // 检查收藏中是否已有该商品
-    if (updateItemInVector(user->favorites, productId, rating)) {
+    // 已在收藏中则更新评分，否则添加新商品到收藏
+    if (!user->favorites.set(productId, rating)) {
         qDebug() << "更新收藏商品评分，用户:" << QString::fromStdString(username) << "商品ID:" << productId << "评分:" << rating;
     }
     else {
-        // 添加新商品到收藏
-        user->favorites.push_back({ productId, rating });
         qDebug() << "添加商品到收藏，用户:" << QString::fromStdString(username) << "商品ID:" << productId << "评分:" << rating;
     }
 
+    markUserDirty(username);
     return true;
 }
 
@@ -672,7 +1369,8 @@ bool DataManager::removeFromFavorites(const std::string& username, int productId
         return false;
     }
 
-    if (removeItemFromVector(user->favorites, productId)) {
+    if (user->favorites.erase(productId)) {
+        markUserDirty(username);
         qDebug() << "从收藏移除商品，用户:" << QString::fromStdString(username) << "商品ID:" << productId;
         return true;
     }
@@ -710,13 +1408,7 @@ bool DataManager::rateProduct(const std::string& username, int productId, int ra
     }
 
     // 查找用户之前的评分
-    int oldRating = -1;
-    for (const auto& entry : user->favorites) {
-        if (entry.size() >= 2 && entry[0] == productId) {
-            oldRating = entry[1];
-            break;
-        }
-    }
+    int oldRating = user->favorites.valueOf(productId, -1);
 
     // 更新商品评分
     if (!updateProductRating(productId, rating, oldRating)) {
@@ -743,6 +1435,11 @@ bool DataManager::updateProductRating(int productId, int newRating, int oldRatin
         return false;
     }
 
+    // 补全排名依赖评分与评价人数：先撤销旧值，更新后再加入
+    if (queryIndexesBuilt) {
+        autocomplete.removeProduct(*product);
+    }
+
     // 如果是新评分（oldRating = -1）
     if (oldRating == -1) {
         // 新用户评分：更新平均评分和评价人数
@@ -755,6 +1452,10 @@ bool DataManager::updateProductRating(int productId, int newRating, int oldRatin
         double totalRating = product->avgRating * product->reviewers - oldRating + newRating;
         product->avgRating = totalRating / product->reviewers;
     }
+    if (queryIndexesBuilt) {
+        autocomplete.addProduct(*product);
+        sortedIndex.updateProduct(static_cast<size_t>(product - products.data()), *product);
+    }
 
     qDebug() << "更新商品评分，ID:" << productId
         << "新评分:" << newRating
@@ -768,68 +1469,136 @@ bool DataManager::updateProductRating(int productId, int newRating, int oldRatin
 // ============== 工具函数 ==============
 
 /**
- * @brief 辅助函数：在二维数组中查找并更新项目
- * @param vec 二维数组引用
- * @param productId 要查找的商品ID（第一列）
- * @param newValue 新值（第二列）
- * @return 找到并更新返回 true，未找到返回 false
+ * @brief 重建用户名索引
+ *
+ * 用户名重复时保留第一条记录，与原先线性查找的结果一致
  */
-bool DataManager::updateItemInVector(std::vector<std::vector<int> >& vec, int productId, int newValue) {
-    for (auto& entry : vec) {
-        if (entry.size() >= 2 && entry[0] == productId) {
-            entry[1] = newValue;
-            return true;
+void DataManager::rebuildUserIndex() {
+    userIndex.clear();
+    userIndex.reserve(users.size());
+    for (size_t i = 0; i < users.size(); i++) {
+        if (!userIndex.contains(users[i].username)) {
+            userIndex.insert(users[i].username, i);
         }
     }
-    return false;
+    indexedUserCount = users.size();
 }
 
 /**
- * @brief 辅助函数：从二维数组中移除项目
- * @param vec 二维数组引用
- * @param productId 要移除的商品ID
- * @return 找到并移除返回 true，未找到返回 false
+ * @brief 重建商品ID索引（ID 重复时保留第一条记录），并丢弃查询索引
+ *
+ * 查询索引由 ensureQueryIndexes() 在下一次查询时按新的商品数据建立
  */
-bool DataManager::removeItemFromVector(std::vector<std::vector<int> >& vec, int productId) {
-    auto it = std::find_if(vec.begin(), vec.end(),
-        [productId](const std::vector<int>& entry) {
-            return entry.size() >= 2 && entry[0] == productId;
-        });
+void DataManager::rebuildProductIndex() {
+    productIndex.clear();
+    productIndex.reserve(products.size());
+    for (size_t i = 0; i < products.size(); i++) {
+        if (!productIndex.contains(products[i].productId)) {
+            productIndex.insert(products[i].productId, i);
+        }
+    }
+    indexedProductCount = products.size();
+
+    if (queryIndexesBuilt) {
+        searchIndex.clear();
+        autocomplete.clear();
+        facetIndex.clear();
+        sortedIndex.clear();
+        stockLedger.clear();
+        queryIndexesBuilt = false;
+    }
+}
 
-    if (it != vec.end()) {
-        vec.erase(it);
-        return true;
+/**
+ * @brief 按需建立搜索、补全、分面、有序索引与库存计数
+ *
+ * 只在第一次查询（或结算）时建立：购物车、收藏等操作使用的临时 DataManager 只需要商品ID索引，
+ * 不必为每次构造付出建立全部查询索引的代价
+ */
+void DataManager::ensureQueryIndexes() {
+    if (indexedProductCount != products.size()) {
+        rebuildProductIndex();
     }
-    return false;
+    if (queryIndexesBuilt) {
+        return;
+    }
+    searchIndex.build(products);
+    autocomplete.build(products);
+    facetIndex.build(products);
+    sortedIndex.build(products);
+    stockLedger.build(products);
+    queryIndexesBuilt = true;
 }
 
-// ============== 搜索与筛选辅助函数 ==============
+/**
+ * @brief 追加用户并更新索引
+ */
+void DataManager::appendUser(UserData user) {
+    users.push_back(std::move(user));
+    userIndex.insert(users.back().username, users.size() - 1);
+    indexedUserCount = users.size();
+}
 
 /**
- * @brief 将字符串转换为小写
- * @param str 输入字符串
- * @return 转换后的小写字符串
+ * @brief 按下标删除用户并更新索引
+ *
+ * 保持其余用户的相对顺序，之后的用户下标整体前移一位
  */
-std::string DataManager::toLowercase(const std::string& str) const {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    return result;
+void DataManager::eraseUserAt(size_t slot) {
+    userIndex.erase(users[slot].username);
+    users.erase(users.begin() + static_cast<std::ptrdiff_t>(slot));
+
+    for (size_t i = slot; i < users.size(); i++) {
+        size_t* indexed = userIndex.find(users[i].username);
+        if (indexed != nullptr && *indexed == i + 1) {
+            *indexed = i;
+        }
+    }
+    indexedUserCount = users.size();
 }
 
 /**
- * @brief 检查文本是否包含关键词（不区分大小写）
- * @param text 要搜索的文本
- * @param keyword 关键词（应为小写）
- * @return 包含返回 true，不包含返回 false
+ * @brief 按下标删除商品并更新索引（保持其余商品的相对顺序）
  */
-bool DataManager::containsKeyword(const std::string& text, const std::string& keyword) const {
-    if (keyword.empty()) {
-        return true;
+void DataManager::eraseProductAt(size_t slot) {
+    productIndex.erase(products[slot].productId);
+    if (queryIndexesBuilt) {
+        if (searchIndex.size() == products.size()) {
+            searchIndex.removeProduct(slot);
+        }
+        if (autocomplete.productCount() == products.size()) {
+            autocomplete.removeProduct(products[slot]);
+        }
+        if (facetIndex.size() == products.size()) {
+            facetIndex.removeProduct(slot);
+        }
+        if (sortedIndex.size() == products.size()) {
+            sortedIndex.removeProduct(slot);
+        }
+        if (stockLedger.size() == products.size()) {
+            stockLedger.removeProduct(slot);
+        }
     }
+    products.erase(products.begin() + static_cast<std::ptrdiff_t>(slot));
 
-    std::string lowercaseText = toLowercase(text);
-    return lowercaseText.find(keyword) != std::string::npos;
+    for (size_t i = slot; i < products.size(); i++) {
+        size_t* indexed = productIndex.find(products[i].productId);
+        if (indexed != nullptr && *indexed == i + 1) {
+            *indexed = i;
+        }
+    }
+    indexedProductCount = products.size();
+}
+
+/**
+ * @brief 商品当前的可用库存：库存计数已建立时以计数为准（已扣除进行中的结算预留），
+ * 尚未建立时不可能有进行中的结算，直接读商品库存
+ */
+int DataManager::availableStock(size_t slot) const {
+    if (queryIndexesBuilt && stockLedger.size() == products.size()) {
+        return stockLedger.available(slot);
+    }
+    return products[slot].stock;
 }
 
 // ============== 私有函数 ==============
@@ -868,9 +1637,9 @@ UserData DataManager::jsonToUser(const json& j) {
     user.userId = j.value("userId", 0);
     user.isAdmin = j.value("isAdmin", false);
     user.salt = j.value("salt", "");
-    user.shoppingCart = j.value("shoppingCart", std::vector<std::vector<int> >());
-    user.viewHistory = j.value("viewHistory", std::vector<std::vector<int> >());
-    user.favorites = j.value("favorites", std::vector<std::vector<int> >());
+    user.shoppingCart = j.value("shoppingCart", InteractionList());
+    user.viewHistory = j.value("viewHistory", InteractionList());
+    user.favorites = j.value("favorites", InteractionList());
 
     return user;
 }
@@ -961,18 +1730,12 @@ bool DataManager::createEmptyJsonFile(const std::string& filename) {
             };
         }
 
-        // 确保目录存在
-        QDir().mkpath(fi.absolutePath());
-
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            qDebug() << "无法创建文件: " << filename;
+        // 原子写入（目录不存在时会自动创建）
+        if (!PersistenceWorker::writeFileAtomically(filename, emptyJson.dump(4))) {
+            qDebug() << "无法创建文件: " << QString::fromStdString(filename);
             return false;
         }
 
-        file << emptyJson.dump(4);
-        file.close();
-
         qDebug() << "成功创建空的 JSON 文件: " << QString::fromStdString(filename);
         return true;
     } catch (const std::exception &e) {
@@ -82,14 +82,14 @@ bool registerUser(const std::string &username, const std::string &password) {
     newUser.userId = dm->getUsers().size() + 1;
 
     // 初始化购物车、浏览历史和收藏夹
-    newUser.shoppingCart = std::vector<std::vector<int> >();
-    newUser.viewHistory = std::vector<std::vector<int> >();
-    newUser.favorites = std::vector<std::vector<int> >();
+    newUser.shoppingCart = InteractionList();
+    newUser.viewHistory = InteractionList();
+    newUser.favorites = InteractionList();
 
     // 添加用户到数据管理器
     if (dm->addUser(newUser)) {
-        // 立即保存用户数据到JSON文件
-        if (dm->saveUsersToJson()) {
+        // 立即保存用户数据到JSON文件（只写入新用户所在的分片）
+        if (dm->saveDirtyUsers()) {
             std::cout << "用户 " << username << " 注册成功并已保存到文件" << std::endl;
             return true;
         } else {
@@ -105,6 +105,12 @@ bool registerUser(const std::string &username, const std::string &password) {
 
 // 登录操作
 bool login(const std::string &username, const std::string &password) {
+    int userId = -1;
+    bool isAdmin = false;
+    return login(username, password, userId, isAdmin);
+}
+
+bool login(const std::string &username, const std::string &password, int &userId, bool &isAdmin) {
     if (username.empty() || password.empty()) {
         qDebug() << "登录失败: 用户名或密码不能为空";
         return false;
@@ -120,6 +126,8 @@ bool login(const std::string &username, const std::string &password) {
 
     // 验证密码
     if (verifyPassword(password, user->password, user->salt)) {
+        userId = user->userId;
+        isAdmin = user->isAdmin;
         qDebug() << "用户 " << username << " 登录成功";
         return true;
     } else {
@@ -128,6 +136,18 @@ bool login(const std::string &username, const std::string &password) {
     }
 }
 
+// 按用户名查找用户ID与管理员身份
+bool lookupUser(const std::string &username, int &userId, bool &isAdmin) {
+    DataManager *dm = getDataManager();
+    UserData *user = dm->findUser(username);
+    if (!user) {
+        return false;
+    }
+    userId = user->userId;
+    isAdmin = user->isAdmin;
+    return true;
+}
+
 // 检查当前用户是否为管理员
 bool isCurrentUserAdmin(const std::string& username) {
     DataManager* dm = getDataManager();
@@ -167,9 +187,10 @@ bool changePassword(const std::string& username, const std::string& oldPassword,
     // 更新用户密码和盐值
     user->password = newHashedPassword;
     user->salt = newSalt;
+    dm->markUserDirty(username);
 
     // 保存更新后的数据
-    if (dm->saveUsersToJson()) {
+    if (dm->saveDirtyUsers()) {
         std::cout << "用户 " << username << " 密码修改成功" << std::endl;
         return true;
     }
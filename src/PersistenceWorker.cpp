@@ -0,0 +1,163 @@
+#include "PersistenceWorker.h"
+#include <chrono>
+#include <algorithm>
+#include <exception>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QString>
+
+/**
+ * @brief 获取进程内唯一的持久化线程
+ *
+ * 单例有意不析构：静态对象的析构顺序不确定，程序退出前（aboutToQuit）以及
+ * 静态 DataManager 实例析构时都可能还要提交或等待写入，必须保证那时后台线程仍然可用
+ */
+PersistenceWorker &PersistenceWorker::instance() {
+    static PersistenceWorker *worker = new PersistenceWorker();
+    return *worker;
+}
+
+PersistenceWorker::PersistenceWorker()
+    : writing(false), nextOwner(1), stats{}, totalWriteMs(0.0) {
+    thread = std::thread(&PersistenceWorker::run, this);
+}
+
+PersistenceWorker::Owner PersistenceWorker::newOwner() {
+    return nextOwner.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 提交一次写入
+ * @param path 目标文件路径
+ * @param serializer 在后台线程中生成文件内容的函数（应只引用调用方拍下的快照）
+ * @param owner 提交者，写入失败时记在它名下
+ *
+ * 如果该路径已有尚未开始的写入，直接用新的序列化函数替换（合并），
+ * 保持其在队列中的原有位置；被替换的提交者也关心这次写入的结果
+ */
+void PersistenceWorker::submit(const std::string &path, Serializer serializer, Owner owner) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.submitted++;
+
+        auto it = pending.find(path);
+        if (it != pending.end()) {
+            it->second.serializer = std::move(serializer);
+            if (std::find(it->second.owners.begin(), it->second.owners.end(), owner) == it->second.owners.end()) {
+                it->second.owners.push_back(owner);
+            }
+            stats.coalesced++;
+        } else {
+            pending.emplace(path, PendingWrite{std::move(serializer), {owner}});
+            order.push_back(path);
+        }
+        stats.queueDepth = order.size();
+    }
+    workAvailable.notify_one();
+}
+
+/**
+ * @brief 写入屏障：阻塞直到队列清空且没有正在进行的写入
+ * @return owner 自上次 flush(owner) 以来提交的写入全部成功返回 true
+ */
+bool PersistenceWorker::flush(Owner owner) {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return order.empty() && !writing; });
+
+    return failedOwners.erase(owner) == 0;
+}
+
+PersistenceMetrics PersistenceWorker::metrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PersistenceMetrics m = stats;
+    m.queueDepth = order.size();
+    m.inFlight = writing ? 1 : 0;
+    return m;
+}
+
+/**
+ * @brief 后台线程主循环：依次取出待写入路径，序列化并原子写入
+ */
+void PersistenceWorker::run() {
+    while (true) {
+        std::string path;
+        PendingWrite write;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return !order.empty(); });
+
+            path = order.front();
+            order.pop_front();
+            auto it = pending.find(path);
+            write = std::move(it->second);
+            pending.erase(it);
+
+            writing = true;
+            stats.queueDepth = order.size();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = false;
+        try {
+            ok = writeFileAtomically(path, write.serializer());
+        } catch (const std::exception &e) {
+            qDebug() << "后台序列化数据时发生错误: " << e.what();
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = false;
+            if (ok) {
+                stats.completed++;
+            } else {
+                stats.failed++;
+                failedOwners.insert(write.owners.begin(), write.owners.end());
+            }
+
+            totalWriteMs += elapsedMs;
+            stats.lastWriteMs = elapsedMs;
+            stats.maxWriteMs = std::max(stats.maxWriteMs, elapsedMs);
+            stats.avgWriteMs = totalWriteMs / static_cast<double>(stats.completed + stats.failed);
+        }
+        idle.notify_all();
+    }
+}
+
+/**
+ * @brief 原子写文件
+ * @param path 目标文件路径
+ * @param content 文件完整内容
+ * @return 写入成功返回 true
+ *
+ * QSaveFile 先写入同目录下的临时文件，commit() 时刷盘并重命名覆盖目标文件；
+ * 任何一步失败都不会破坏原文件
+ */
+bool PersistenceWorker::writeFileAtomically(const std::string &path, const std::string &content) {
+    QString target = QString::fromStdString(path);
+
+    // 确保目录存在
+    QFileInfo fi(target);
+    QDir().mkpath(fi.absolutePath());
+
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法打开临时文件进行写入: " << target << file.errorString();
+        return false;
+    }
+
+    if (file.write(content.data(), static_cast<qint64>(content.size())) != static_cast<qint64>(content.size())) {
+        qDebug() << "写入临时文件失败: " << target << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) {
+        qDebug() << "提交文件失败: " << target << file.errorString();
+        return false;
+    }
+    return true;
+}
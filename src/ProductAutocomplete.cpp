@@ -0,0 +1,396 @@
+#include "ProductAutocomplete.h"
+#include "ProductSearchIndex.h"
+#include "DataManager.h"
+#include <algorithm>
+
+namespace {
+    // 商品名称中的单词分隔符（已经过归一化，全角符号已转为半角）
+    bool isSeparator(char32_t c) {
+        switch (c) {
+            case U' ': case U'\t': case U'-': case U'_': case U'/': case U'\\':
+            case U'(': case U')': case U'[': case U']': case U',': case U'.':
+            case U'+': case U'|': case U'&': case U'，': case U'、': case U'·':
+            case U'【': case U'】': case U'《': case U'》':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::u32string normalizeKey(std::string_view text) {
+        std::u32string key = ProductSearchIndex::normalize(text);
+        size_t start = 0;
+        while (start < key.size() && (key[start] == U' ' || key[start] == U'\t')) {
+            start++;
+        }
+        return key.substr(start);
+    }
+}
+
+ProductAutocomplete::ProductAutocomplete() : totalProducts(0) {
+    nodes.emplace_back();
+}
+
+void ProductAutocomplete::clear() {
+    terms.clear();
+    freeTerms.clear();
+    nameTerms.clear();
+    categoryTerms.clear();
+    nodes.clear();
+    nodes.emplace_back();
+    totalProducts = 0;
+}
+
+/**
+ * @brief 为全部商品重建前缀树
+ */
+void ProductAutocomplete::build(const std::vector<ProductData> &products) {
+    clear();
+    for (const auto &product : products) {
+        addProduct(product);
+    }
+}
+
+void ProductAutocomplete::addProduct(const ProductData &product) {
+    contribute(product.name, false, product, 1);
+    contribute(product.category, true, product, 1);
+    totalProducts++;
+}
+
+void ProductAutocomplete::removeProduct(const ProductData &product) {
+    contribute(product.name, false, product, -1);
+    contribute(product.category, true, product, -1);
+    if (totalProducts > 0) {
+        totalProducts--;
+    }
+}
+
+/**
+ * @brief 查询补全建议
+ * @param prefix 用户已输入的文本
+ * @param limit 最多返回的条数
+ * @return 按热度、评分排序的建议
+ *
+ * limit 不超过 kCachedTop 时直接读取节点缓存，耗时只与前缀长度有关
+ */
+std::vector<ProductCompletion> ProductAutocomplete::complete(const std::string &prefix, size_t limit) const {
+    std::vector<ProductCompletion> results;
+    const std::u32string query = normalizeKey(prefix);
+    if (query.empty() || limit == 0) {
+        return results;
+    }
+
+    uint32_t current = 0;
+    size_t pos = 0;
+    while (pos < query.size()) {
+        int index = findChild(current, query[pos]);
+        if (index < 0) {
+            return results;
+        }
+        uint32_t child = nodes[current].children[static_cast<size_t>(index)];
+        const std::u32string &label = nodes[child].label;
+
+        size_t matched = 0;
+        while (matched < label.size() && pos + matched < query.size() && label[matched] == query[pos + matched]) {
+            matched++;
+        }
+        if (pos + matched < query.size() && matched < label.size()) {
+            return results; // 前缀在边的中途分叉
+        }
+        current = child;
+        pos += matched;
+    }
+
+    std::vector<uint32_t> ids;
+    if (limit <= kCachedTop) {
+        const std::vector<uint32_t> &top = nodes[current].top;
+        ids.assign(top.begin(), top.begin() + static_cast<std::ptrdiff_t>(std::min(limit, top.size())));
+    } else {
+        collectAll(current, ids);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        size_t count = std::min(limit, ids.size());
+        std::partial_sort(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(count), ids.end(),
+                          [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); });
+        ids.resize(count);
+    }
+
+    results.reserve(ids.size());
+    for (uint32_t id : ids) {
+        results.push_back({terms[id].text, terms[id].isCategory, terms[id].products});
+    }
+    return results;
+}
+
+/**
+ * @brief 把一个商品对某个名称/分类词条的贡献加上（sign = 1）或撤销（sign = -1）
+ */
+void ProductAutocomplete::contribute(std::string_view text, bool isCategory, const ProductData &product, int sign) {
+    std::u32string key = normalizeKey(text);
+    if (key.empty()) {
+        return;
+    }
+
+    FlatHashMap<std::u32string, uint32_t> &lookup = isCategory ? categoryTerms : nameTerms;
+    const uint32_t *found = lookup.find(key);
+
+    if (sign > 0) {
+        bool created = false;
+        uint32_t id;
+        if (found != nullptr) {
+            id = *found;
+        } else {
+            if (!freeTerms.empty()) {
+                id = freeTerms.back();
+                freeTerms.pop_back();
+                terms[id] = Term();
+            } else {
+                id = static_cast<uint32_t>(terms.size());
+                terms.emplace_back();
+            }
+            terms[id].text = std::string(text);
+            terms[id].key = key;
+            terms[id].isCategory = isCategory;
+            lookup.insert(key, id);
+            created = true;
+        }
+
+        Term &term = terms[id];
+        term.products++;
+        term.popularity += product.reviewers + 1;
+        term.ratingSum += product.avgRating;
+
+        if (created) {
+            for (const auto &k : keysOf(term)) {
+                nodes[insertKey(k)].terms.push_back(id);
+            }
+        }
+        promote(id);
+        return;
+    }
+
+    if (found == nullptr) {
+        return;
+    }
+    const uint32_t id = *found;
+    Term &term = terms[id];
+    term.products--;
+    term.popularity -= product.reviewers + 1;
+    term.ratingSum -= product.avgRating;
+
+    if (term.products > 0) {
+        demote(id);
+        return;
+    }
+
+    // 最后一个商品被删除：从前缀树中摘除词条
+    for (const auto &k : keysOf(term)) {
+        std::vector<uint32_t> path;
+        if (pathTo(k, path)) {
+            std::vector<uint32_t> &owned = nodes[path.back()].terms;
+            owned.erase(std::remove(owned.begin(), owned.end(), id), owned.end());
+        }
+    }
+    lookup.erase(key);
+    demote(id);
+    terms[id].text.clear();
+    terms[id].key.clear();
+    freeTerms.push_back(id);
+}
+
+bool ProductAutocomplete::ranksBefore(uint32_t a, uint32_t b) const {
+    const Term &ta = terms[a];
+    const Term &tb = terms[b];
+    if (ta.popularity != tb.popularity) {
+        return ta.popularity > tb.popularity;
+    }
+    double ra = ta.products > 0 ? ta.ratingSum / ta.products : 0.0;
+    double rb = tb.products > 0 ? tb.ratingSum / tb.products : 0.0;
+    if (ra != rb) {
+        return ra > rb;
+    }
+    return a < b;
+}
+
+/**
+ * @brief 词条在前缀树中的全部键：分类只有整体；名称还包括每个单词开头的后缀
+ */
+std::vector<std::u32string> ProductAutocomplete::keysOf(const Term &term) const {
+    std::vector<std::u32string> keys;
+    keys.push_back(term.key);
+    if (term.isCategory) {
+        return keys;
+    }
+
+    for (size_t i = 1; i < term.key.size(); i++) {
+        if (isSeparator(term.key[i - 1]) && !isSeparator(term.key[i])) {
+            keys.push_back(term.key.substr(i));
+        }
+    }
+    return keys;
+}
+
+// 二分查找 label 首字符为 first 的子节点，返回其在 children 中的位置，不存在返回 -1
+int ProductAutocomplete::findChild(uint32_t node, char32_t first) const {
+    const std::vector<uint32_t> &children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), first,
+                               [this](uint32_t child, char32_t c) { return nodes[child].label[0] < c; });
+    if (it == children.end() || nodes[*it].label[0] != first) {
+        return -1;
+    }
+    return static_cast<int>(it - children.begin());
+}
+
+/**
+ * @brief 插入一个键，返回键结束处的节点（必要时拆分已有的边）
+ */
+uint32_t ProductAutocomplete::insertKey(const std::u32string &key) {
+    uint32_t current = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        int index = findChild(current, key[pos]);
+        if (index < 0) {
+            Node leaf;
+            leaf.label = key.substr(pos);
+            uint32_t leafIndex = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(std::move(leaf));
+
+            std::vector<uint32_t> &children = nodes[current].children;
+            auto it = std::lower_bound(children.begin(), children.end(), key[pos],
+                                       [this](uint32_t child, char32_t c) { return nodes[child].label[0] < c; });
+            children.insert(it, leafIndex);
+            return leafIndex;
+        }
+
+        uint32_t child = nodes[current].children[static_cast<size_t>(index)];
+        size_t matched = 0;
+        {
+            const std::u32string &label = nodes[child].label;
+            while (matched < label.size() && pos + matched < key.size() && label[matched] == key[pos + matched]) {
+                matched++;
+            }
+            if (matched == label.size()) {
+                current = child;
+                pos += matched;
+                continue;
+            }
+        }
+
+        // 键在边的中途结束或分叉：拆分出中间节点，继承子节点的缓存
+        Node middle;
+        middle.label = nodes[child].label.substr(0, matched);
+        middle.children.push_back(child);
+        middle.top = nodes[child].top;
+        nodes[child].label.erase(0, matched);
+
+        uint32_t middleIndex = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(std::move(middle));
+        nodes[current].children[static_cast<size_t>(index)] = middleIndex;
+
+        current = middleIndex;
+        pos += matched;
+    }
+    return current;
+}
+
+/**
+ * @brief 查找从根到键结束节点的路径
+ * @return 键存在（恰好在某个节点结束）返回 true
+ */
+bool ProductAutocomplete::pathTo(const std::u32string &key, std::vector<uint32_t> &path) const {
+    path.clear();
+    path.push_back(0);
+    uint32_t current = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        int index = findChild(current, key[pos]);
+        if (index < 0) {
+            return false;
+        }
+        uint32_t child = nodes[current].children[static_cast<size_t>(index)];
+        const std::u32string &label = nodes[child].label;
+        if (key.compare(pos, label.size(), label) != 0) {
+            return false;
+        }
+        current = child;
+        pos += label.size();
+        path.push_back(current);
+    }
+    return true;
+}
+
+void ProductAutocomplete::promote(uint32_t term) {
+    std::vector<uint32_t> path;
+    for (const auto &key : keysOf(terms[term])) {
+        if (!pathTo(key, path)) {
+            continue;
+        }
+        for (uint32_t node : path) {
+            std::vector<uint32_t> &top = nodes[node].top;
+            top.erase(std::remove(top.begin(), top.end(), term), top.end());
+            auto it = std::lower_bound(top.begin(), top.end(), term,
+                                       [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); });
+            if (static_cast<size_t>(it - top.begin()) < kCachedTop) {
+                top.insert(it, term);
+                if (top.size() > kCachedTop) {
+                    top.pop_back();
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 某节点的缓存中没有该词条时，其祖先的缓存中也不会有（祖先的候选集合包含该节点的候选集合），
+ * 因此可以在第一个不含该词条的节点处停止向上
+ */
+void ProductAutocomplete::demote(uint32_t term) {
+    std::vector<uint32_t> path;
+    for (const auto &key : keysOf(terms[term])) {
+        if (!pathTo(key, path)) {
+            continue;
+        }
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            const std::vector<uint32_t> &top = nodes[*it].top;
+            if (std::find(top.begin(), top.end(), term) == top.end()) {
+                break;
+            }
+            recomputeTop(*it);
+        }
+    }
+}
+
+void ProductAutocomplete::recomputeTop(uint32_t node) {
+    std::vector<uint32_t> candidates;
+    for (uint32_t id : nodes[node].terms) {
+        if (terms[id].products > 0) {
+            candidates.push_back(id);
+        }
+    }
+    for (uint32_t child : nodes[node].children) {
+        const std::vector<uint32_t> &top = nodes[child].top;
+        candidates.insert(candidates.end(), top.begin(), top.end());
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    size_t count = std::min(kCachedTop, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(count), candidates.end(),
+                      [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); });
+    candidates.resize(count);
+    nodes[node].top.swap(candidates);
+}
+
+void ProductAutocomplete::collectAll(uint32_t node, std::vector<uint32_t> &out) const {
+    std::vector<uint32_t> stack{node};
+    while (!stack.empty()) {
+        uint32_t current = stack.back();
+        stack.pop_back();
+        for (uint32_t id : nodes[current].terms) {
+            if (terms[id].products > 0) {
+                out.push_back(id);
+            }
+        }
+        stack.insert(stack.end(), nodes[current].children.begin(), nodes[current].children.end());
+    }
+}
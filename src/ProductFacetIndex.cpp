@@ -0,0 +1,268 @@
+#include "ProductFacetIndex.h"
+#include "DataManager.h"
+#include <algorithm>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    size_t wordCount(size_t bits) {
+        return (bits + 63) / 64;
+    }
+
+    // 最后一个字中超出 size 的位清零用的掩码
+    uint64_t tailMask(size_t size) {
+        size_t rest = size % 64;
+        return rest == 0 ? ~0ULL : ((1ULL << rest) - 1);
+    }
+
+    int countBits(uint64_t word) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    // word 不能为 0
+    int lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+}
+
+void ProductFacetIndex::clear() {
+    categoryNames.clear();
+    categoryIds.clear();
+    postings.clear();
+    categoryOf.clear();
+    prices.clear();
+    inStock.clear();
+}
+
+void ProductFacetIndex::build(const std::vector<ProductData> &products) {
+    clear();
+    categoryOf.reserve(products.size());
+    prices.reserve(products.size());
+    inStock.reserve(wordCount(products.size()));
+    for (size_t i = 0; i < products.size(); i++) {
+        addProduct(i, products[i]);
+    }
+}
+
+void ProductFacetIndex::addProduct(size_t slot, const ProductData &product) {
+    uint32_t id = categoryIdOf(product.category);
+    postings[id].push_back(static_cast<uint32_t>(slot));
+    categoryOf.push_back(id);
+    prices.push_back(product.price);
+
+    if (inStock.size() < wordCount(categoryOf.size())) {
+        inStock.push_back(0);
+    }
+    setInStock(slot, product.stock > 0);
+}
+
+/**
+ * @brief 删除商品：从分类倒排表中移除，其余倒排表中大于 slot 的下标减一，
+ *        各列删除对应元素，库存位图整体右移一位
+ */
+void ProductFacetIndex::removeProduct(size_t slot) {
+    if (slot >= categoryOf.size()) {
+        return;
+    }
+
+    const uint32_t removed = static_cast<uint32_t>(slot);
+    std::vector<uint32_t> &own = postings[categoryOf[slot]];
+    auto found = std::lower_bound(own.begin(), own.end(), removed);
+    if (found != own.end() && *found == removed) {
+        own.erase(found);
+    }
+    for (auto &list : postings) {
+        for (auto it = std::upper_bound(list.begin(), list.end(), removed); it != list.end(); ++it) {
+            --*it;
+        }
+    }
+
+    categoryOf.erase(categoryOf.begin() + static_cast<std::ptrdiff_t>(slot));
+    prices.erase(prices.begin() + static_cast<std::ptrdiff_t>(slot));
+
+    const size_t word = slot / 64;
+    const uint64_t lowMask = (1ULL << (slot % 64)) - 1;
+    inStock[word] = (inStock[word] & lowMask) | ((inStock[word] >> 1) & ~lowMask);
+    for (size_t i = word + 1; i < inStock.size(); i++) {
+        inStock[i - 1] |= (inStock[i] & 1ULL) << 63;
+        inStock[i] >>= 1;
+    }
+    inStock.resize(wordCount(categoryOf.size()));
+}
+
+void ProductFacetIndex::updateProduct(size_t slot, const ProductData &product) {
+    if (slot >= categoryOf.size()) {
+        return;
+    }
+
+    uint32_t id = categoryIdOf(product.category);
+    if (id != categoryOf[slot]) {
+        const uint32_t value = static_cast<uint32_t>(slot);
+        std::vector<uint32_t> &from = postings[categoryOf[slot]];
+        auto it = std::lower_bound(from.begin(), from.end(), value);
+        if (it != from.end() && *it == value) {
+            from.erase(it);
+        }
+        std::vector<uint32_t> &to = postings[id];
+        to.insert(std::lower_bound(to.begin(), to.end(), value), value);
+        categoryOf[slot] = id;
+    }
+    prices[slot] = product.price;
+    setInStock(slot, product.stock > 0);
+}
+
+const std::vector<uint32_t> *ProductFacetIndex::categorySlots(std::string_view category) const {
+    const uint32_t *id = categoryIds.find(category);
+    return id ? &postings[*id] : nullptr;
+}
+
+/**
+ * @brief 组合筛选
+ *
+ * 关键词与分类位图由倒排表生成，价格与库存条件在逐字扫描时按列求出；
+ * 每个字一次得到结果位以及三个分面各自"排除自身条件"的位，据此累计计数
+ */
+ProductQueryResult ProductFacetIndex::query(const ProductQuery &query, const std::vector<size_t> *ranked) const {
+    ProductQueryResult result;
+    const size_t count = categoryOf.size();
+    const size_t words = wordCount(count);
+
+    std::vector<uint64_t> keywordBits;
+    if (ranked != nullptr) {
+        keywordBits.assign(words, 0);
+        for (size_t slot : *ranked) {
+            if (slot < count) {
+                keywordBits[slot / 64] |= 1ULL << (slot % 64);
+            }
+        }
+    }
+
+    const bool filterCategory = !query.category.empty() && query.category != "全部";
+    std::vector<uint64_t> categoryBits;
+    if (filterCategory) {
+        categoryBits.assign(words, 0);
+        if (const std::vector<uint32_t> *list = categorySlots(query.category)) {
+            for (uint32_t slot : *list) {
+                categoryBits[slot / 64] |= 1ULL << (slot % 64);
+            }
+        }
+    }
+
+    const bool filterPrice = query.minPrice >= 0.0 || query.maxPrice >= 0.0;
+    const double low = query.minPrice >= 0.0 ? query.minPrice : -std::numeric_limits<double>::infinity();
+    const double high = query.maxPrice >= 0.0 ? query.maxPrice : std::numeric_limits<double>::infinity();
+
+    std::vector<int> perCategory(categoryNames.size(), 0);
+    std::vector<uint64_t> matched(words, 0);
+    double minPrice = std::numeric_limits<double>::infinity();
+    double maxPrice = -std::numeric_limits<double>::infinity();
+
+    for (size_t w = 0; w < words; w++) {
+        const uint64_t valid = (w + 1 == words) ? tailMask(count) : ~0ULL;
+        const uint64_t k = ranked != nullptr ? keywordBits[w] : valid;
+        const uint64_t c = filterCategory ? categoryBits[w] : valid;
+        const uint64_t s = inStock[w];
+        const uint64_t stockFilter = query.inStockOnly ? s : valid;
+
+        // 每个分面的位都包含关键词条件，价格只需对关键词命中的商品判断
+        uint64_t p = valid;
+        if (filterPrice) {
+            p = 0;
+            uint64_t candidates = k & valid;
+            while (candidates != 0) {
+                const int bit = lowestBit(candidates);
+                candidates &= candidates - 1;
+                const double price = prices[w * 64 + static_cast<size_t>(bit)];
+                if (price >= low && price <= high) {
+                    p |= 1ULL << bit;
+                }
+            }
+        }
+
+        matched[w] = k & c & p & stockFilter;
+
+        // 分类分面：排除分类条件
+        uint64_t categoryFacet = k & p & stockFilter;
+        while (categoryFacet != 0) {
+            const int bit = lowestBit(categoryFacet);
+            categoryFacet &= categoryFacet - 1;
+            perCategory[categoryOf[w * 64 + static_cast<size_t>(bit)]]++;
+        }
+
+        // 库存分面：排除库存条件
+        const uint64_t stockFacet = k & c & p;
+        result.inStockCount += countBits(stockFacet & s);
+        result.outOfStockCount += countBits(stockFacet & ~s);
+
+        // 价格分面：排除价格条件，统计价格范围
+        uint64_t priceFacet = k & c & stockFilter;
+        while (priceFacet != 0) {
+            const int bit = lowestBit(priceFacet);
+            priceFacet &= priceFacet - 1;
+            const double price = prices[w * 64 + static_cast<size_t>(bit)];
+            minPrice = std::min(minPrice, price);
+            maxPrice = std::max(maxPrice, price);
+        }
+    }
+
+    if (minPrice <= maxPrice) {
+        result.minPrice = minPrice;
+        result.maxPrice = maxPrice;
+    }
+
+    for (size_t id = 0; id < categoryNames.size(); id++) {
+        if (!postings[id].empty()) {
+            result.categoryCounts.push_back({categoryNames[id].str(), perCategory[id]});
+        }
+    }
+
+    if (ranked != nullptr) {
+        for (size_t slot : *ranked) {
+            if (slot < count && (matched[slot / 64] >> (slot % 64) & 1ULL)) {
+                result.matches.push_back(slot);
+            }
+        }
+    } else {
+        for (size_t w = 0; w < words; w++) {
+            uint64_t bits = matched[w];
+            while (bits != 0) {
+                const int bit = lowestBit(bits);
+                bits &= bits - 1;
+                result.matches.push_back(w * 64 + static_cast<size_t>(bit));
+            }
+        }
+    }
+    return result;
+}
+
+uint32_t ProductFacetIndex::categoryIdOf(const PooledString &category) {
+    if (const uint32_t *id = categoryIds.find(category.view())) {
+        return *id;
+    }
+    uint32_t id = static_cast<uint32_t>(categoryNames.size());
+    categoryNames.push_back(category);
+    postings.emplace_back();
+    categoryIds.insert(category.view(), id);
+    return id;
+}
+
+void ProductFacetIndex::setInStock(size_t slot, bool value) {
+    const uint64_t bit = 1ULL << (slot % 64);
+    if (value) {
+        inStock[slot / 64] |= bit;
+    } else {
+        inStock[slot / 64] &= ~bit;
+    }
+}
@@ -0,0 +1,247 @@
+#include "ProductSearchIndex.h"
+#include "DataManager.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief 计算商品与关键词的匹配得分，0 表示不匹配
+     *
+     * 名称完全匹配 > 名称前缀匹配（名称越短越靠前）> 名称中间匹配（位置越靠前越好）> 分类匹配
+     */
+    int matchScore(const std::u32string &name, const std::u32string &category, const std::u32string &query) {
+        size_t pos = name.find(query);
+        if (pos != std::u32string::npos) {
+            if (name.size() == query.size()) {
+                return 1000;
+            }
+            if (pos == 0) {
+                return 800 - static_cast<int>(std::min<size_t>(name.size(), 100));
+            }
+            return 600 - static_cast<int>(std::min<size_t>(pos, 100));
+        }
+
+        if (category.find(query) != std::u32string::npos) {
+            return category.size() == query.size() ? 300 : 200;
+        }
+        return 0;
+    }
+}
+
+void ProductSearchIndex::clear() {
+    entries.clear();
+    postings.clear();
+}
+
+/**
+ * @brief 为全部商品重建索引
+ */
+void ProductSearchIndex::build(const std::vector<ProductData> &products) {
+    clear();
+    entries.reserve(products.size());
+    for (size_t i = 0; i < products.size(); i++) {
+        addProduct(i, products[i]);
+    }
+}
+
+/**
+ * @brief 追加一个商品到索引
+ * @param slot 商品在 products 中的下标（等于当前已索引的商品数）
+ * @param product 商品数据
+ *
+ * 新下标总是最大的，直接追加到各倒排表末尾即可保持升序
+ */
+void ProductSearchIndex::addProduct(size_t slot, const ProductData &product) {
+    Entry entry{normalize(product.name), normalize(product.category)};
+
+    std::vector<uint64_t> grams;
+    collectGrams(entry.name, grams);
+    collectGrams(entry.category, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    for (uint64_t gram : grams) {
+        postings.getOrInsert(gram).push_back(static_cast<uint32_t>(slot));
+    }
+    entries.push_back(std::move(entry));
+}
+
+/**
+ * @brief 从索引中删除一个商品
+ * @param slot 商品下标
+ *
+ * 先从该商品自己的 gram 倒排表中移除，再把所有倒排表中大于 slot 的下标减一
+ */
+void ProductSearchIndex::removeProduct(size_t slot) {
+    if (slot >= entries.size()) {
+        return;
+    }
+
+    std::vector<uint64_t> grams;
+    collectGrams(entries[slot].name, grams);
+    collectGrams(entries[slot].category, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    const uint32_t removed = static_cast<uint32_t>(slot);
+    for (uint64_t gram : grams) {
+        std::vector<uint32_t> *list = postings.find(gram);
+        if (list == nullptr) {
+            continue;
+        }
+        auto it = std::lower_bound(list->begin(), list->end(), removed);
+        if (it != list->end() && *it == removed) {
+            list->erase(it);
+        }
+        if (list->empty()) {
+            postings.erase(gram);
+        }
+    }
+
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(slot));
+    postings.forEach([removed](const uint64_t &, std::vector<uint32_t> &list) {
+        for (auto it = std::upper_bound(list.begin(), list.end(), removed); it != list.end(); ++it) {
+            --*it;
+        }
+    });
+}
+
+/**
+ * @brief 按关键词搜索商品
+ * @param keyword 关键词（不区分大小写，支持中文）
+ * @param products 与索引对应的商品数据，用于排序时读取评分
+ * @return 按相关度排序的商品下标
+ *
+ * 1. 关键词长度 ≥ 3 时取其全部 3-gram，否则取整个关键词作为一个 gram
+ * 2. 从最短的倒排表开始求交集，候选足够少时提前停止
+ * 3. 在候选商品上核对子串（交集只保证各 gram 都出现，不保证连续）
+ * 4. 按匹配得分、平均评分、评价人数排序
+ */
+std::vector<size_t> ProductSearchIndex::search(const std::string &keyword,
+                                               const std::vector<ProductData> &products) const {
+    std::vector<size_t> results;
+    const std::u32string query = normalize(keyword);
+    if (query.empty()) {
+        return results;
+    }
+
+    const size_t n = std::min<size_t>(query.size(), 3);
+    std::vector<const std::vector<uint32_t> *> lists;
+    for (size_t i = 0; i + n <= query.size(); i++) {
+        const std::vector<uint32_t> *list = postings.find(gramKey(&query[i], n));
+        if (list == nullptr) {
+            return results; // 某个 gram 从未出现，必然没有匹配
+        }
+        lists.push_back(list);
+    }
+
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<uint32_t> *a, const std::vector<uint32_t> *b) {
+                  return a->size() < b->size();
+              });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    std::vector<uint32_t> candidates = *lists[0];
+    std::vector<uint32_t> merged;
+    for (size_t i = 1; i < lists.size() && candidates.size() > 16; i++) {
+        merged.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(merged));
+        candidates.swap(merged);
+    }
+
+    std::vector<std::pair<int, size_t> > scored;
+    for (uint32_t slot : candidates) {
+        int score = matchScore(entries[slot].name, entries[slot].category, query);
+        if (score > 0) {
+            scored.emplace_back(score, slot);
+        }
+    }
+
+    std::sort(scored.begin(), scored.end(),
+              [&products](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b) {
+                  if (a.first != b.first) return a.first > b.first;
+                  const ProductData &pa = products[a.second];
+                  const ProductData &pb = products[b.second];
+                  if (pa.avgRating != pb.avgRating) return pa.avgRating > pb.avgRating;
+                  if (pa.reviewers != pb.reviewers) return pa.reviewers > pb.reviewers;
+                  return a.second < b.second;
+              });
+
+    results.reserve(scored.size());
+    for (const auto &item : scored) {
+        results.push_back(item.second);
+    }
+    return results;
+}
+
+/**
+ * @brief 文本归一化
+ * @param text UTF-8 文本
+ * @return 归一化后的字符序列
+ *
+ * - 非法的 UTF-8 字节按单字节原样保留，不会中断解码
+ * - 全角字母、数字、符号（！～）转为半角，全角空格转为半角空格
+ * - ASCII 大写字母转小写
+ */
+std::u32string ProductSearchIndex::normalize(std::string_view text) {
+    std::u32string result;
+    result.reserve(text.size());
+
+    size_t i = 0;
+    while (i < text.size()) {
+        const unsigned char lead = static_cast<unsigned char>(text[i]);
+        char32_t cp = lead;
+        size_t length = 1;
+
+        if (lead >= 0xC0 && lead < 0xF8) {
+            size_t expected = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : 2);
+            if (i + expected <= text.size()) {
+                char32_t decoded = lead & (0x7F >> expected);
+                bool valid = true;
+                for (size_t k = 1; k < expected; k++) {
+                    const unsigned char c = static_cast<unsigned char>(text[i + k]);
+                    if ((c & 0xC0) != 0x80) {
+                        valid = false;
+                        break;
+                    }
+                    decoded = (decoded << 6) | (c & 0x3F);
+                }
+                if (valid && decoded <= 0x10FFFF) {
+                    cp = decoded;
+                    length = expected;
+                }
+            }
+        }
+        i += length;
+
+        if (cp >= 0xFF01 && cp <= 0xFF5E) {
+            cp -= 0xFEE0;
+        } else if (cp == 0x3000) {
+            cp = U' ';
+        }
+        if (cp >= U'A' && cp <= U'Z') {
+            cp += U'a' - U'A';
+        }
+        if (cp != 0) {
+            result.push_back(cp);
+        }
+    }
+    return result;
+}
+
+uint64_t ProductSearchIndex::gramKey(const char32_t *text, size_t n) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < n; i++) {
+        key |= static_cast<uint64_t>(text[i]) << (21 * i);
+    }
+    return key;
+}
+
+void ProductSearchIndex::collectGrams(const std::u32string &text, std::vector<uint64_t> &grams) {
+    for (size_t i = 0; i < text.size(); i++) {
+        for (size_t n = 1; n <= 3 && i + n <= text.size(); n++) {
+            grams.push_back(gramKey(&text[i], n));
+        }
+    }
+}
@@ -0,0 +1,313 @@
+#include "ProductSortedIndex.h"
+#include "DataManager.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    /**
+     * @brief 以 runEnd 结尾的同值段的起点
+     *
+     * 从段尾往前按 1、2、4…的步长试探，再在最后一步内二分，代价为 O(log 段长)
+     */
+    template <typename Iterator>
+    Iterator runStart(Iterator first, Iterator runEnd) {
+        const double value = (runEnd - 1)->value;
+        Iterator bound = runEnd - 1;
+        std::ptrdiff_t step = 1;
+        while (bound - first >= step && (bound - step)->value == value) {
+            bound -= step;
+            step *= 2;
+        }
+        const Iterator low = bound - first >= step ? bound - step : first;
+        return std::lower_bound(low, bound, value, [](const auto &entry, double v) { return entry.value < v; });
+    }
+
+    /**
+     * @brief 按降序访问有序数组的 [first, last)：值从大到小，同值按下标升序
+     * @param skip 跳过降序的前 skip 个
+     * @param visit 返回 false 时停止
+     *
+     * 从后往前逐段处理同值的一段，段内顺序访问；第 skip 个所在的段二分定位，之后每段的起点由 runStart 得到
+     */
+    template <typename Iterator, typename Visit>
+    void forEachDescending(Iterator first, Iterator last, size_t skip, Visit visit) {
+        if (skip >= static_cast<size_t>(last - first)) {
+            return;
+        }
+
+        // 降序第 skip 个所在的同值段
+        const Iterator target = last - 1 - static_cast<std::ptrdiff_t>(skip);
+        Iterator runBegin = std::lower_bound(first, target, target->value,
+                                             [](const auto &entry, double v) { return entry.value < v; });
+        Iterator runEnd = std::upper_bound(target, last, target->value,
+                                           [](double v, const auto &entry) { return v < entry.value; });
+        Iterator it = runBegin + static_cast<std::ptrdiff_t>(skip - static_cast<size_t>(last - runEnd));
+        while (true) {
+            for (; it != runEnd; ++it) {
+                if (!visit(*it)) {
+                    return;
+                }
+            }
+            if (runBegin == first) {
+                return;
+            }
+            runEnd = runBegin;
+            runBegin = runStart(first, runEnd);
+            it = runBegin;
+        }
+    }
+}
+
+void ProductSortedIndex::clear() {
+    for (size_t k = 0; k < kKeyCount; k++) {
+        sorted[k].clear();
+        values[k].clear();
+    }
+}
+
+/**
+ * @brief 重建索引：一次性排序，比逐个插入快
+ */
+void ProductSortedIndex::build(const std::vector<ProductData> &products) {
+    clear();
+    for (size_t k = 0; k < kKeyCount; k++) {
+        const ProductSortKey key = static_cast<ProductSortKey>(k);
+        values[k].reserve(products.size());
+        sorted[k].reserve(products.size());
+        for (size_t i = 0; i < products.size(); i++) {
+            double value = valueOf(products[i], key);
+            values[k].push_back(value);
+            sorted[k].push_back({value, static_cast<uint32_t>(i)});
+        }
+        std::sort(sorted[k].begin(), sorted[k].end(), entryLess);
+    }
+}
+
+void ProductSortedIndex::addProduct(size_t slot, const ProductData &product) {
+    for (size_t k = 0; k < kKeyCount; k++) {
+        double value = valueOf(product, static_cast<ProductSortKey>(k));
+        values[k].push_back(value);
+        insertEntry(k, value, static_cast<uint32_t>(slot));
+    }
+}
+
+void ProductSortedIndex::removeProduct(size_t slot) {
+    if (slot >= size()) {
+        return;
+    }
+
+    const uint32_t removed = static_cast<uint32_t>(slot);
+    for (size_t k = 0; k < kKeyCount; k++) {
+        eraseEntry(k, values[k][slot], removed);
+        values[k].erase(values[k].begin() + static_cast<std::ptrdiff_t>(slot));
+        for (auto &entry : sorted[k]) {
+            if (entry.slot > removed) {
+                entry.slot--;
+            }
+        }
+    }
+}
+
+void ProductSortedIndex::updateProduct(size_t slot, const ProductData &product) {
+    if (slot >= size()) {
+        return;
+    }
+
+    for (size_t k = 0; k < kKeyCount; k++) {
+        double value = valueOf(product, static_cast<ProductSortKey>(k));
+        if (value == values[k][slot]) {
+            continue;
+        }
+        eraseEntry(k, values[k][slot], static_cast<uint32_t>(slot));
+        insertEntry(k, value, static_cast<uint32_t>(slot));
+        values[k][slot] = value;
+    }
+}
+
+/**
+ * @brief 范围 + 排序 + 分页查询
+ * @param query 查询条件
+ * @return 本页商品下标与满足范围条件的总数
+ *
+ * 总数由范围字段上的两次二分得到。取一页时：
+ * - 范围字段与排序字段相同：直接截取有序数组中的一段
+ * - 不同：按排序字段顺序遍历并检查范围，期望代价约为 (offset + limit) * P / 范围内数量；
+ *   若取出范围内全部商品再排序更便宜（范围很窄时），则改用后者
+ */
+ProductPage ProductSortedIndex::query(const ProductRangeQuery &query) const {
+    ProductPage page;
+    const size_t rangeIndex = static_cast<size_t>(query.rangeKey);
+    const size_t sortIndex = static_cast<size_t>(query.sortKey);
+    const std::vector<Entry> &range = sorted[rangeIndex];
+
+    const double low = query.minValue >= 0.0 ? query.minValue : -std::numeric_limits<double>::infinity();
+    const double high = query.maxValue >= 0.0 ? query.maxValue : std::numeric_limits<double>::infinity();
+    if (low > high) {
+        return page;
+    }
+
+    auto first = std::lower_bound(range.begin(), range.end(), low,
+                                  [](const Entry &e, double v) { return e.value < v; });
+    auto last = std::upper_bound(range.begin(), range.end(), high,
+                                 [](double v, const Entry &e) { return v < e.value; });
+    page.total = static_cast<size_t>(last - first);
+    if (query.offset >= page.total || query.limit == 0) {
+        return page;
+    }
+    const size_t count = std::min(query.limit, page.total - query.offset);
+    page.matches.reserve(count);
+
+    if (rangeIndex == sortIndex) {
+        if (query.descending) {
+            forEachDescending(first, last, query.offset, [&](const Entry &entry) {
+                page.matches.push_back(entry.slot);
+                return page.matches.size() < count;
+            });
+        } else {
+            auto it = first + static_cast<std::ptrdiff_t>(query.offset);
+            for (size_t i = 0; i < count; i++, ++it) {
+                page.matches.push_back(it->slot);
+            }
+        }
+        return page;
+    }
+
+    const double needed = static_cast<double>(query.offset + count);
+    const double walkCost = needed * static_cast<double>(size()) / static_cast<double>(page.total);
+    const double sliceCost = static_cast<double>(page.total) * std::log2(static_cast<double>(page.total) + 1.0);
+    const std::vector<double> &rangeValues = values[rangeIndex];
+
+    if (walkCost <= sliceCost) {
+        const std::vector<Entry> &order = sorted[sortIndex];
+        size_t skipped = 0;
+        auto take = [&](const Entry &entry) {
+            const double value = rangeValues[entry.slot];
+            if (value < low || value > high) {
+                return true;
+            }
+            if (skipped < query.offset) {
+                skipped++;
+                return true;
+            }
+            page.matches.push_back(entry.slot);
+            return page.matches.size() < count;
+        };
+        if (query.descending) {
+            forEachDescending(order.begin(), order.end(), 0, take);
+        } else {
+            for (auto it = order.begin(); it != order.end() && take(*it); ++it) {}
+        }
+        return page;
+    }
+
+    const std::vector<double> &sortValues = values[sortIndex];
+    std::vector<Entry> slice;
+    slice.reserve(page.total);
+    for (auto it = first; it != last; ++it) {
+        slice.push_back({sortValues[it->slot], it->slot});
+    }
+    const size_t end = query.offset + count;
+    if (query.descending) {
+        std::partial_sort(slice.begin(), slice.begin() + static_cast<std::ptrdiff_t>(end), slice.end(), entryGreater);
+    } else {
+        std::partial_sort(slice.begin(), slice.begin() + static_cast<std::ptrdiff_t>(end), slice.end(), entryLess);
+    }
+    for (size_t i = query.offset; i < end; i++) {
+        page.matches.push_back(slice[i].slot);
+    }
+    return page;
+}
+
+/**
+ * @brief 把一组商品下标按字段排列，同值按下标升序
+ *
+ * 在"按字段顺序遍历有序数组、只取出标记过的下标"（O(P)）与"按字段值直接排序这组下标"
+ * （O(m log m)，m 为下标个数）之间选代价较低的一种；两者都只读索引中的值，不访问商品数据
+ */
+void ProductSortedIndex::order(std::vector<size_t> &matches, ProductSortKey key, bool descending) const {
+    const size_t keyIndex = static_cast<size_t>(key);
+    const std::vector<double> &keyValues = values[keyIndex];
+    if (matches.size() < 2) {
+        return;
+    }
+    const double m = static_cast<double>(matches.size());
+
+    if (static_cast<double>(size()) <= m * std::log2(m)) {
+        std::vector<uint64_t> marked((size() + 63) / 64, 0);
+        for (size_t slot : matches) {
+            if (slot < size()) {
+                marked[slot / 64] |= 1ULL << (slot % 64);
+            }
+        }
+        const size_t total = matches.size();
+        matches.clear();
+        auto take = [&](const Entry &entry) {
+            if (marked[entry.slot / 64] & (1ULL << (entry.slot % 64))) {
+                matches.push_back(entry.slot);
+            }
+            return matches.size() < total;
+        };
+        const std::vector<Entry> &list = sorted[keyIndex];
+        if (descending) {
+            forEachDescending(list.begin(), list.end(), 0, take);
+        } else {
+            for (auto it = list.begin(); it != list.end() && take(*it); ++it) {}
+        }
+        return;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(matches.size());
+    for (size_t slot : matches) {
+        entries.push_back({slot < size() ? keyValues[slot] : 0.0, static_cast<uint32_t>(slot)});
+    }
+    std::sort(entries.begin(), entries.end(), descending ? entryGreater : entryLess);
+    for (size_t i = 0; i < entries.size(); i++) {
+        matches[i] = entries[i].slot;
+    }
+}
+
+double ProductSortedIndex::valueOf(const ProductData &product, ProductSortKey key) {
+    switch (key) {
+        case ProductSortKey::Price:
+            return product.price;
+        case ProductSortKey::AvgRating:
+            return product.avgRating;
+        case ProductSortKey::Reviewers:
+            return product.reviewers;
+        case ProductSortKey::Stock:
+            return product.stock;
+    }
+    return 0.0;
+}
+
+bool ProductSortedIndex::entryLess(const Entry &a, const Entry &b) {
+    if (a.value != b.value) {
+        return a.value < b.value;
+    }
+    return a.slot < b.slot;
+}
+
+// 降序：值从大到小，同值仍按下标升序
+bool ProductSortedIndex::entryGreater(const Entry &a, const Entry &b) {
+    if (a.value != b.value) {
+        return a.value > b.value;
+    }
+    return a.slot < b.slot;
+}
+
+void ProductSortedIndex::insertEntry(size_t key, double value, uint32_t slot) {
+    std::vector<Entry> &list = sorted[key];
+    const Entry entry{value, slot};
+    list.insert(std::lower_bound(list.begin(), list.end(), entry, entryLess), entry);
+}
+
+void ProductSortedIndex::eraseEntry(size_t key, double value, uint32_t slot) {
+    std::vector<Entry> &list = sorted[key];
+    const Entry entry{value, slot};
+    auto it = std::lower_bound(list.begin(), list.end(), entry, entryLess);
+    if (it != list.end() && it->slot == slot && it->value == value) {
+        list.erase(it);
+    }
+}
@@ -5,6 +5,7 @@
 #include <utility>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 // 定义命名空间内的全局变量
 namespace Recommender
@@ -47,86 +48,46 @@ namespace Recommender
         const double CART_WEIGHT = 0.25;  // 购物车权重
         const double VIEW_WEIGHT = 0.15;  // 浏览次数权重
 
-        // 为每个商品构建一个映射，记录评分、是否在购物车、浏览次数
-        std::unordered_map<int, double> ratings; // 商品ID -> 评分
-        std::unordered_map<int, bool> inCart;    // 商品ID -> 是否在购物车
-        std::unordered_map<int, int> viewCounts; // 商品ID -> 浏览次数
+        // 收藏、购物车、浏览历史都按商品ID升序排列，三路归并即可遍历所有有交互的商品，
+        // 不需要为每个用户建立哈希表
+        auto favorite = user.favorites.begin();
+        auto cartItem = user.shoppingCart.begin();
+        auto viewItem = user.viewHistory.begin();
+        const auto favoriteEnd = user.favorites.end();
+        const auto cartEnd = user.shoppingCart.end();
+        const auto viewEnd = user.viewHistory.end();
 
-        // 1. 处理收藏（favorites）数据，获取评分
-        // favorites格式: [[商品ID, 评分], ...]
-        for (const auto &favorite : user.favorites)
-        {
-            if (favorite.size() >= 2)
-            {
-                int productId = favorite[0];
-                int rating = favorite[1];
-                ratings[productId] = rating;
-            }
-        }
+        interestScores.reserve(std::max({user.favorites.size(), user.shoppingCart.size(), user.viewHistory.size()}));
 
-        // 2. 处理购物车（shoppingCart）数据
-        // shoppingCart格式: [[商品ID, 数量, ...], ...]
-        for (const auto &cartItem : user.shoppingCart)
+        while (favorite != favoriteEnd || cartItem != cartEnd || viewItem != viewEnd)
         {
-            if (!cartItem.empty())
-            {
-                int productId = cartItem[0];
-                inCart[productId] = true;
-            }
-        }
+            // 当前最小的商品ID
+            int productId = std::numeric_limits<int>::max();
+            if (favorite != favoriteEnd) productId = std::min(productId, favorite->productId);
+            if (cartItem != cartEnd) productId = std::min(productId, cartItem->productId);
+            if (viewItem != viewEnd) productId = std::min(productId, viewItem->productId);
 
-        // 3. 处理浏览历史（viewHistory）数据
-        // viewHistory格式: [[商品ID, 浏览次数, ...], ...]
-        for (const auto &viewItem : user.viewHistory)
-        {
-            if (viewItem.size() >= 2)
-            {
-                int productId = viewItem[0];
-                int views = viewItem[1];
-                viewCounts[productId] = views;
-            } else if (viewItem.size() == 1) {
-                int productId = viewItem[0];
-                viewCounts[productId] = 1; // 默认浏览1次
-            }
-        }
-
-        // 4. 收集所有用户有交互的商品ID
-        std::unordered_map<int, bool> interactedProducts;
-        for (const auto &pair: ratings) {
-            int productId = pair.first;
-            interactedProducts[productId] = true;
-        }
-        for (const auto &pair: inCart) {
-            int productId = pair.first;
-            interactedProducts[productId] = true;
-        }
-        for (const auto &pair: viewCounts) {
-            int productId = pair.first;
-            interactedProducts[productId] = true;
-        }
-
-        // 5. 为每个有交互的商品计算兴趣值
-        for (const auto &pair : interactedProducts)
-        {
-            int productId = pair.first;
             // 评分因素 f_r = (r - 1) / 4
             double f_r = 0.0;
-            if (ratings.find(productId) != ratings.end()) {
-                double r = ratings[productId];
+            if (favorite != favoriteEnd && favorite->productId == productId) {
+                double r = favorite->value;
                 f_r = (r - 1.0) / 4.0; // 将[1,5]映射到[0,1]
+                ++favorite;
             }
 
             // 购物车因素 f_c
             double f_c = 0.0;
-            if (inCart.find(productId) != inCart.end() && inCart[productId]) {
+            if (cartItem != cartEnd && cartItem->productId == productId) {
                 f_c = 1.0;
+                ++cartItem;
             }
 
             // 浏览次数因素 使用饱和函数 f_v = 1 - exp(-0.2 * v)
             double f_v = 0.0;
-            if (viewCounts.find(productId) != viewCounts.end()) {
-                int v = viewCounts[productId];
+            if (viewItem != viewEnd && viewItem->productId == productId) {
+                int v = viewItem->value;
                 f_v = 1.0 - std::exp(-0.2 * v);
+                ++viewItem;
             }
 
             // 计算加权兴趣值
@@ -135,7 +96,7 @@ namespace Recommender
             // 确保兴趣值在[0,1]范围内
             interestValue = std::max(0.0, std::min(1.0, interestValue));
 
-            // 添加到结果中：{商品ID, 兴趣值}
+            // 添加到结果中：{商品ID, 兴趣值}，按商品ID升序
             interestScores.push_back({productId, interestValue});
         }
 
@@ -459,10 +420,10 @@ QVariantList RecommenderWrapper::getRecommendations(const QString& username, int
             if (product) {
                 QVariantMap productMap;
                 productMap["productId"] = product->productId;
-                productMap["name"] = QString::fromStdString(product->name);
+                productMap["name"] = product->name.toQString();
                 productMap["price"] = product->price;
                 productMap["stock"] = product->stock;
-                productMap["category"] = QString::fromStdString(product->category);
+                productMap["category"] = product->category.toQString();
                 productMap["avgRating"] = product->avgRating;
                 productMap["reviewers"] = product->reviewers;
                 
@@ -486,7 +447,7 @@ QVariantList RecommenderWrapper::getRecommendations(const QString& username, int
                 
                 qDebug() << QString("[%1] %2 | 评分: %3")
                     .arg(result.size())
-                    .arg(QString::fromStdString(product->name))
+                    .arg(product->name.toQString())
                     .arg(score, 0, 'f', 3);
             }
         }
@@ -1,19 +1,39 @@
 #include "StateManager.h"
 #include "Login.h"
+#include <unordered_map>
 
 // 全局状态变量定义
 AppState g_currentState = STATE_LOGIN;
 bool g_isLoggedIn = false;
 QString g_currentUsername = "";
+QString g_sessionToken = "";
+
+// 会话表：令牌 -> 会话信息
+static std::unordered_map<std::string, SessionInfo> g_sessions;
+static bool g_sessionsDirty = false; // 会话表自上次保存以来有变化
 
 // 初始化应用程序状态
 void initializeApp() {
 	loadAppState();
 	
-	// 如果用户已登录，根据用户权限决定初始状态
-	if (g_isLoggedIn && !g_currentUsername.isEmpty()) {
-		// 检查用户是否为管理员
-		if (isCurrentUserAdmin(g_currentUsername.toStdString())) {
+	// 如果用户已登录，按会话令牌自动登录
+	SessionInfo session;
+	bool sessionValid = g_isLoggedIn && !g_currentUsername.isEmpty() && findSession(g_sessionToken, session);
+	if (sessionValid) {
+		// 会话建立后用户数据可能已变化（重新加载、删除、降权）：核对用户仍存在且ID一致，权限以用户数据为准
+		int userId = -1;
+		bool isAdmin = false;
+		if (lookupUser(g_currentUsername.toStdString(), userId, isAdmin) && userId == session.userId) {
+			updateUserSessions(userId, isAdmin);
+			session.isAdmin = isAdmin;
+		} else {
+			qDebug() << "会话对应的用户已不存在，撤销会话:" << g_currentUsername;
+			revokeSession(g_sessionToken);
+			sessionValid = false;
+		}
+	}
+	if (sessionValid) {
+		if (session.isAdmin) {
 			g_currentState = STATE_ADMIN;
 			qDebug() << "管理员" << g_currentUsername << "自动登录到管理页面";
 		} else {
@@ -21,10 +41,15 @@ void initializeApp() {
 			qDebug() << "用户" << g_currentUsername << "自动登录到主菜单";
 		}
 	} else {
+		// 未登录，或会话已过期、已撤销：需要重新登录
+		g_isLoggedIn = false;
+		g_currentUsername.clear();
+		g_sessionToken.clear();
 		g_currentState = STATE_LOGIN;
 		qDebug() << "未登录，跳转到登录页面";
 	}
 	
+	saveAppState();
 	qDebug() << "初始化应用程序...";
 }
 
@@ -42,12 +67,17 @@ AppState getCurrentState() {
 
 // 登录操作（包装器函数，用于更新状态）
 bool loginWithStateUpdate(const std::string& username, const std::string& password) {
-	if (login(username, password)) {
+	int userId = -1;
+	bool isAdmin = false;
+	if (login(username, password, userId, isAdmin)) {
+		// 新会话替换本机之前的会话
+		revokeSession(g_sessionToken);
+		g_sessionToken = createSession(userId, isAdmin);
 		g_isLoggedIn = true;
 		g_currentUsername = QString::fromStdString(username);
 
 		// 根据用户权限决定跳转页面
-		if (isCurrentUserAdmin(username)) {
+		if (isAdmin) {
 			setState(STATE_ADMIN);  // 管理员跳转到管理页面
 			qDebug() << "管理员" << username << "登录成功";
 		}
@@ -65,6 +95,8 @@ bool loginWithStateUpdate(const std::string& username, const std::string& passwo
 
 // 登出操作
 void logout() {
+	revokeSession(g_sessionToken);
+	g_sessionToken.clear();
 	g_isLoggedIn = false;
 	g_currentUsername.clear();	// 清空当前用户名
 	setState(STATE_LOGIN);	// 设置为登录状态
@@ -87,6 +119,27 @@ void saveAppState() {
 	settings.setValue("isLoggedIn", g_isLoggedIn);
 	settings.setValue("currentUser", g_currentUsername);
 	settings.setValue("currentState", static_cast<int>(g_currentState));	// 将枚举值转换为整数进行存储
+	settings.setValue("sessionToken", g_sessionToken);
+
+	// 会话表只在变化后重写，过期的会话不再保存
+	if (g_sessionsDirty) {
+		const qint64 now = QDateTime::currentMSecsSinceEpoch();
+		settings.remove("sessions");
+		settings.beginWriteArray("sessions");
+		int index = 0;
+		for (const auto& [token, session] : g_sessions) {
+			if (session.expiresAt <= now) {
+				continue;
+			}
+			settings.setArrayIndex(index++);
+			settings.setValue("token", QString::fromStdString(token));
+			settings.setValue("userId", session.userId);
+			settings.setValue("isAdmin", session.isAdmin);
+			settings.setValue("expiresAt", session.expiresAt);
+		}
+		settings.endArray();
+		g_sessionsDirty = false;
+	}
 }
 
 // 从配置文件加载应用程序状态
@@ -95,5 +148,108 @@ void loadAppState() {
 	g_isLoggedIn = settings.value("isLoggedIn", false).toBool();
 	g_currentUsername = settings.value("currentUser", "").toString();
 	g_currentState = static_cast<AppState>(settings.value("currentState", STATE_LOGIN).toInt()); // 从整数转换回枚举值
+	g_sessionToken = settings.value("sessionToken", "").toString();
+
+	g_sessions.clear();
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	const int count = settings.beginReadArray("sessions");
+	g_sessions.reserve(count);
+	for (int i = 0; i < count; i++) {
+		settings.setArrayIndex(i);
+		SessionInfo session;
+		session.userId = settings.value("userId", -1).toInt();
+		session.isAdmin = settings.value("isAdmin", false).toBool();
+		session.expiresAt = settings.value("expiresAt", 0).toLongLong();
+		if (session.expiresAt > now) {
+			g_sessions[settings.value("token").toString().toStdString()] = session;
+		} else {
+			g_sessionsDirty = true;
+		}
+	}
+	settings.endArray();
+}
+
+// ========== 会话管理 ==========
+
+// 令牌：128 位系统随机数的十六进制串，不含任何用户信息
+static QString generateSessionToken() {
+	quint32 words[4];
+	QRandomGenerator::system()->fillRange(words, 4);
+	return QString::fromLatin1(QByteArray(reinterpret_cast<const char*>(words), sizeof(words)).toHex());
+}
+
+QString createSession(int userId, bool isAdmin) {
+	QString token = generateSessionToken();
+	SessionInfo session;
+	session.userId = userId;
+	session.isAdmin = isAdmin;
+	session.expiresAt = QDateTime::currentMSecsSinceEpoch() + qint64(kSessionLifetimeDays) * 24 * 60 * 60 * 1000;
+	g_sessions[token.toStdString()] = session;
+	g_sessionsDirty = true;
+	return token;
+}
+
+bool findSession(const QString& token, SessionInfo& info) {
+	if (token.isEmpty()) {
+		return false;
+	}
+	auto it = g_sessions.find(token.toStdString());
+	if (it == g_sessions.end()) {
+		return false;
+	}
+	if (it->second.expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+		g_sessions.erase(it);
+		g_sessionsDirty = true;
+		return false;
+	}
+	info = it->second;
+	return true;
+}
+
+void revokeSession(const QString& token) {
+	if (!token.isEmpty() && g_sessions.erase(token.toStdString()) > 0) {
+		g_sessionsDirty = true;
+	}
+}
+
+void revokeUserSessions(int userId) {
+	for (auto it = g_sessions.begin(); it != g_sessions.end();) {
+		if (it->second.userId == userId) {
+			it = g_sessions.erase(it);
+			g_sessionsDirty = true;
+		} else {
+			++it;
+		}
+	}
+}
+
+void updateUserSessions(int userId, bool isAdmin) {
+	for (auto& [token, session] : g_sessions) {
+		if (session.userId == userId && session.isAdmin != isAdmin) {
+			session.isAdmin = isAdmin;
+			g_sessionsDirty = true;
+		}
+	}
+}
+
+void refreshSessions(const std::function<bool(int userId, bool& isAdmin)>& lookup) {
+	for (auto it = g_sessions.begin(); it != g_sessions.end();) {
+		bool isAdmin = false;
+		if (!lookup(it->second.userId, isAdmin)) {
+			it = g_sessions.erase(it);
+			g_sessionsDirty = true;
+			continue;
+		}
+		if (it->second.isAdmin != isAdmin) {
+			it->second.isAdmin = isAdmin;
+			g_sessionsDirty = true;
+		}
+		++it;
+	}
+}
+
+bool isCurrentSessionAdmin() {
+	SessionInfo session;
+	return g_isLoggedIn && findSession(g_sessionToken, session) && session.isAdmin;
 }
 
@@ -0,0 +1,85 @@
+#include "StockLedger.h"
+#include "DataManager.h"
+
+void StockLedger::clear() {
+    counters.reset();
+    count = 0;
+    capacity = 0;
+}
+
+void StockLedger::build(const std::vector<ProductData> &products) {
+    clear();
+    grow(products.size());
+    for (size_t i = 0; i < products.size(); i++) {
+        addProduct(i, products[i].stock);
+    }
+}
+
+void StockLedger::addProduct(size_t slot, int stock) {
+    if (slot != count) {
+        return;
+    }
+    if (count == capacity) {
+        grow(count + 1);
+    }
+    counters[count].store(stock, std::memory_order_relaxed);
+    count++;
+}
+
+void StockLedger::removeProduct(size_t slot) {
+    if (slot >= count) {
+        return;
+    }
+    for (size_t i = slot + 1; i < count; i++) {
+        counters[i - 1].store(counters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    count--;
+}
+
+int StockLedger::available(size_t slot) const {
+    return slot < count ? counters[slot].load(std::memory_order_acquire) : 0;
+}
+
+/**
+ * @brief 预留库存：读取当前值，足够时用 CAS 写回扣减后的值；
+ *        其他线程在此期间修改了计数则 CAS 失败，用最新值重试
+ */
+bool StockLedger::tryReserve(size_t slot, int quantity) {
+    if (slot >= count || quantity <= 0) {
+        return false;
+    }
+    std::atomic<int> &counter = counters[slot];
+    int current = counter.load(std::memory_order_acquire);
+    while (current >= quantity) {
+        if (counter.compare_exchange_weak(current, current - quantity,
+                                          std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StockLedger::release(size_t slot, int quantity) {
+    if (slot < count && quantity > 0) {
+        counters[slot].fetch_add(quantity, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief 扩容：按两倍增长，std::atomic 不可移动，逐个搬移计数值
+ */
+void StockLedger::grow(size_t minCapacity) {
+    if (minCapacity <= capacity) {
+        return;
+    }
+    size_t newCapacity = capacity == 0 ? 64 : capacity;
+    while (newCapacity < minCapacity) {
+        newCapacity *= 2;
+    }
+    std::unique_ptr<std::atomic<int>[]> grown(new std::atomic<int>[newCapacity]);
+    for (size_t i = 0; i < count; i++) {
+        grown[i].store(counters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    counters = std::move(grown);
+    capacity = newCapacity;
+}
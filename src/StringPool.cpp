@@ -0,0 +1,130 @@
+#include "StringPool.h"
+#include <cstring>
+
+/**
+ * @brief 获取进程内唯一的字符串池
+ *
+ * 与 PersistenceWorker 相同，单例有意不析构：驻留字符串要在所有静态对象析构期间都保持有效
+ */
+StringPool &StringPool::instance() {
+    static StringPool *pool = new StringPool();
+    return *pool;
+}
+
+StringPool::StringPool() : table(1024, nullptr), count(0), blockUsed(kBlockSize), totalBytes(0) {}
+
+/**
+ * @brief 驻留字符串
+ * @param text 字符串内容
+ * @return 驻留后的字符串，内容相同时返回同一地址；空字符串返回空的 string_view
+ */
+std::string_view StringPool::intern(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+
+    const uint32_t hash = hashOf(text);
+    const auto length = static_cast<uint32_t>(text.size());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t mask = table.size() - 1;
+    size_t pos = hash & mask;
+    while (const char *existing = table[pos]) {
+        const Header &header = headerOf(existing);
+        if (header.hash == hash && header.length == length &&
+            std::memcmp(existing, text.data(), length) == 0) {
+            return {existing, length};
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    // 字符串写入池中：[Header][内容]['\0']
+    char *record = allocate(sizeof(Header) + text.size() + 1);
+    const Header header{hash, length};
+    std::memcpy(record, &header, sizeof(Header));
+    char *copy = record + sizeof(Header);
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+
+    table[pos] = copy;
+    if (++count * 10 > table.size() * 7) {
+        grow();
+    }
+    return {copy, length};
+}
+
+size_t StringPool::stringCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+size_t StringPool::bytesUsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalBytes;
+}
+
+/**
+ * @brief 32 位 FNV-1a 哈希，再做一次 murmur3 的末尾混合，使低位也足够分散
+ */
+uint32_t StringPool::hashOf(std::string_view text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+const StringPool::Header &StringPool::headerOf(const char *text) {
+    return *reinterpret_cast<const Header *>(text - sizeof(Header));
+}
+
+/**
+ * @brief 去重表扩容为两倍，按头部保存的哈希值重新放置
+ */
+void StringPool::grow() {
+    std::vector<const char *> bigger(table.size() * 2, nullptr);
+    const size_t mask = bigger.size() - 1;
+    for (const char *text : table) {
+        if (!text) {
+            continue;
+        }
+        size_t pos = headerOf(text).hash & mask;
+        while (bigger[pos]) {
+            pos = (pos + 1) & mask;
+        }
+        bigger[pos] = text;
+    }
+    table.swap(bigger);
+}
+
+/**
+ * @brief 从当前大块中顺序分配（按 Header 对齐）；剩余空间不足时换新块，超过块大小 1/4 的字符串单独分配一块
+ */
+char *StringPool::allocate(size_t size) {
+    size = (size + alignof(Header) - 1) & ~(alignof(Header) - 1);
+    totalBytes += size;
+
+    if (size > kBlockSize / 4) {
+        blocks.emplace_back(new char[size]);
+        char *own = blocks.back().get();
+        // 单独的块放到倒数第二个位置，当前块仍可继续使用
+        if (blocks.size() >= 2) {
+            std::swap(blocks[blocks.size() - 1], blocks[blocks.size() - 2]);
+        }
+        return own;
+    }
+
+    if (blockUsed + size > kBlockSize) {
+        blocks.emplace_back(new char[kBlockSize]);
+        blockUsed = 0;
+    }
+    char *result = blocks.back().get() + blockUsed;
+    blockUsed += size;
+    return result;
+}
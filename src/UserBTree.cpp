@@ -0,0 +1,408 @@
+#include "UserBTree.h"
+#include <algorithm>
+#include "DataManager.h"
+
+namespace {
+// 节点内查找：对整个定长键数组比较计数，不分支，循环次数固定，编译器可以向量化
+// 只计入前 count 个位置，未使用的位置不参与比较，因此任何 int（包括 INT_MAX）都可以作为键
+
+// 前 count 个键中小于 key 的键数，即第一个不小于 key 的位置
+template <int N>
+int lowerSlot(const int (&keys)[N], int count, int key) {
+    int slot = 0;
+    for (int i = 0; i < N; i++) {
+        slot += (i < count) & (keys[i] < key);
+    }
+    return slot;
+}
+
+// 前 childCount - 1 个分隔键中不大于 key 的键数，即 key 所在的孩子
+template <int N>
+int childSlot(const int (&keys)[N], int childCount, int key) {
+    int slot = 0;
+    for (int i = 0; i < N; i++) {
+        slot += (i < childCount - 1) & (keys[i] <= key);
+    }
+    return slot;
+}
+} // namespace
+
+void UserBTree::clear() {
+    destroy(root);
+    root = nullptr;
+    head = nullptr;
+    count = 0;
+    leafPool.clear();
+    innerPool.clear();
+}
+
+void UserBTree::destroy(Node *node) {
+    if (node == nullptr) {
+        return;
+    }
+    if (node->leaf) {
+        leafPool.destroy(static_cast<Leaf *>(node));
+        return;
+    }
+    Inner *inner = static_cast<Inner *>(node);
+    for (int i = 0; i < inner->count; i++) {
+        destroy(inner->children[i]);
+    }
+    innerPool.destroy(inner);
+}
+
+/**
+ * @brief 自底向上建树：先把记录顺序装满叶子，再逐层把满 kInnerFanout 个孩子装入一个内部节点，
+ *        每层记录各节点子树的最小键（作为父节点中的分隔键）与键数
+ */
+void UserBTree::build(const std::vector<Record> &sorted) {
+    clear();
+    if (sorted.empty()) {
+        return;
+    }
+
+    std::vector<Node *> level;
+    std::vector<int> minKeys;
+    std::vector<uint32_t> sizes;
+    Leaf *previous = nullptr;
+    for (size_t begin = 0; begin < sorted.size(); begin += kLeafCapacity) {
+        Leaf *leaf = leafPool.create();
+        const size_t end = std::min(sorted.size(), begin + kLeafCapacity);
+        for (size_t i = begin; i < end; i++) {
+            leaf->keys[leaf->count] = sorted[i]->userId;
+            leaf->values[leaf->count] = sorted[i];
+            leaf->count++;
+        }
+        leaf->prev = previous;
+        if (previous != nullptr) {
+            previous->next = leaf;
+        } else {
+            head = leaf;
+        }
+        previous = leaf;
+        level.push_back(leaf);
+        minKeys.push_back(leaf->keys[0]);
+        sizes.push_back(static_cast<uint32_t>(leaf->count));
+    }
+
+    while (level.size() > 1) {
+        std::vector<Node *> parents;
+        std::vector<int> parentKeys;
+        std::vector<uint32_t> parentSizes;
+        for (size_t begin = 0; begin < level.size(); begin += kInnerFanout) {
+            Inner *inner = innerPool.create();
+            const size_t end = std::min(level.size(), begin + kInnerFanout);
+            uint32_t total = 0;
+            for (size_t i = begin; i < end; i++) {
+                if (i > begin) {
+                    inner->keys[inner->count - 1] = minKeys[i];
+                }
+                inner->children[inner->count] = level[i];
+                inner->sizes[inner->count] = sizes[i];
+                inner->count++;
+                total += sizes[i];
+            }
+            parents.push_back(inner);
+            parentKeys.push_back(minKeys[begin]);
+            parentSizes.push_back(total);
+        }
+        level.swap(parents);
+        minKeys.swap(parentKeys);
+        sizes.swap(parentSizes);
+    }
+
+    root = level.front();
+    count = sorted.size();
+}
+
+bool UserBTree::insert(Record record) {
+    const int key = record->userId;
+    if (root == nullptr) {
+        head = leafPool.create();
+        root = head;
+    }
+
+    Split split;
+    if (!insertInto(root, key, record, split)) {
+        return false;
+    }
+    if (split.right != nullptr) {
+        // 根节点分裂：新根只有两个孩子
+        Inner *top = innerPool.create();
+        top->count = 2;
+        top->keys[0] = split.key;
+        top->children[0] = root;
+        top->children[1] = split.right;
+        top->sizes[0] = static_cast<uint32_t>(count + 1 - split.size);
+        top->sizes[1] = split.size;
+        root = top;
+    }
+    count++;
+    return true;
+}
+
+bool UserBTree::insertInto(Node *node, int key, Record &record, Split &split) {
+    if (node->leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        int pos = lowerSlot(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && leaf->keys[pos] == key) {
+            return false;
+        }
+
+        Leaf *target = leaf;
+        if (leaf->count == kLeafCapacity) {
+            // 在末尾插入时左叶子保持满，新叶子只放新键；否则对半分
+            const int half = pos == kLeafCapacity ? kLeafCapacity : kLeafCapacity / 2;
+            Leaf *right = leafPool.create();
+            for (int i = half; i < kLeafCapacity; i++) {
+                right->keys[i - half] = leaf->keys[i];
+                right->values[i - half] = std::move(leaf->values[i]);
+            }
+            right->count = kLeafCapacity - half;
+            leaf->count = half;
+            std::fill(leaf->keys + half, leaf->keys + kLeafCapacity, kEmptyKey);
+
+            right->prev = leaf;
+            right->next = leaf->next;
+            if (right->next != nullptr) {
+                right->next->prev = right;
+            }
+            leaf->next = right;
+
+            if (pos >= half) {
+                target = right;
+                pos -= half;
+            }
+            split.right = right;
+        }
+
+        for (int i = target->count; i > pos; i--) {
+            target->keys[i] = target->keys[i - 1];
+            target->values[i] = std::move(target->values[i - 1]);
+        }
+        target->keys[pos] = key;
+        target->values[pos] = std::move(record);
+        target->count++;
+
+        if (split.right != nullptr) {
+            Leaf *right = static_cast<Leaf *>(split.right);
+            split.key = right->keys[0];
+            split.size = static_cast<uint32_t>(right->count);
+        }
+        return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const int slot = childSlot(inner->keys, inner->count, key);
+    Split childSplit;
+    if (!insertInto(inner->children[slot], key, record, childSplit)) {
+        return false;
+    }
+    if (childSplit.right == nullptr) {
+        inner->sizes[slot]++;
+        return true;
+    }
+    inner->sizes[slot] = inner->sizes[slot] + 1 - childSplit.size;
+
+    const int newSlot = slot + 1;
+    if (inner->count < kInnerFanout) {
+        insertChild(inner, newSlot, childSplit.key, childSplit.right, childSplit.size);
+        return true;
+    }
+
+    // 内部节点已满：前 middle 个孩子留下，其余移到新节点，两者之间的分隔键交给父节点；
+    // 新孩子在末尾时左节点只让出最后一个孩子
+    const int middle = newSlot == kInnerFanout ? kInnerFanout - 1 : kInnerFanout / 2;
+    Inner *right = innerPool.create();
+    split.key = inner->keys[middle - 1];
+    for (int i = middle; i < kInnerFanout; i++) {
+        right->children[i - middle] = inner->children[i];
+        right->sizes[i - middle] = inner->sizes[i];
+        if (i > middle) {
+            right->keys[i - middle - 1] = inner->keys[i - 1];
+        }
+    }
+    right->count = kInnerFanout - middle;
+    inner->count = middle;
+    std::fill(inner->keys + middle - 1, inner->keys + kInnerFanout - 1, kEmptyKey);
+
+    if (newSlot <= middle) {
+        insertChild(inner, newSlot, childSplit.key, childSplit.right, childSplit.size);
+    } else {
+        insertChild(right, newSlot - middle, childSplit.key, childSplit.right, childSplit.size);
+    }
+
+    split.right = right;
+    split.size = 0;
+    for (int i = 0; i < right->count; i++) {
+        split.size += right->sizes[i];
+    }
+    return true;
+}
+
+// 在 slot（>= 1）处插入孩子，key 为它与左侧孩子之间的分隔键；调用方保证节点未满
+void UserBTree::insertChild(Inner *inner, int slot, int key, Node *child, uint32_t size) {
+    for (int i = inner->count; i > slot; i--) {
+        inner->children[i] = inner->children[i - 1];
+        inner->sizes[i] = inner->sizes[i - 1];
+        inner->keys[i - 1] = inner->keys[i - 2];
+    }
+    inner->children[slot] = child;
+    inner->sizes[slot] = size;
+    inner->keys[slot - 1] = key;
+    inner->count++;
+}
+
+// 移除 slot 处的孩子以及它与左侧孩子之间的分隔键（第一个孩子则移除它右侧的分隔键）
+void UserBTree::removeChild(Inner *inner, int slot) {
+    for (int i = slot; i + 1 < inner->count; i++) {
+        inner->children[i] = inner->children[i + 1];
+        inner->sizes[i] = inner->sizes[i + 1];
+    }
+    for (int i = slot > 0 ? slot - 1 : 0; i + 2 < inner->count; i++) {
+        inner->keys[i] = inner->keys[i + 1];
+    }
+    if (inner->count >= 2) {
+        inner->keys[inner->count - 2] = kEmptyKey;
+    }
+    inner->count--;
+}
+
+UserBTree::Record UserBTree::erase(int userId) {
+    Record removed;
+    if (root == nullptr || !eraseFrom(root, userId, removed)) {
+        return removed;
+    }
+    count--;
+
+    // 树空时回收剩下的节点；根节点只剩一个孩子时降低树高
+    if (count == 0) {
+        clear();
+        return removed;
+    }
+    while (!root->leaf && root->count == 1) {
+        Inner *top = static_cast<Inner *>(root);
+        root = top->children[0];
+        innerPool.destroy(top);
+    }
+    return removed;
+}
+
+bool UserBTree::eraseFrom(Node *node, int key, Record &removed) {
+    if (node->leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        const int pos = lowerSlot(leaf->keys, leaf->count, key);
+        if (pos >= leaf->count || leaf->keys[pos] != key) {
+            return false;
+        }
+        removed = std::move(leaf->values[pos]);
+        for (int i = pos + 1; i < leaf->count; i++) {
+            leaf->keys[i - 1] = leaf->keys[i];
+            leaf->values[i - 1] = std::move(leaf->values[i]);
+        }
+        leaf->count--;
+        leaf->keys[leaf->count] = kEmptyKey;
+        return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const int slot = childSlot(inner->keys, inner->count, key);
+    Node *child = inner->children[slot];
+    if (!eraseFrom(child, key, removed)) {
+        return false;
+    }
+    inner->sizes[slot]--;
+
+    // 孩子变空时摘下并回收；空叶子同时从叶子链表中移除
+    if (child->count == 0) {
+        if (child->leaf) {
+            Leaf *leaf = static_cast<Leaf *>(child);
+            if (leaf->prev != nullptr) {
+                leaf->prev->next = leaf->next;
+            } else {
+                head = leaf->next;
+            }
+            if (leaf->next != nullptr) {
+                leaf->next->prev = leaf->prev;
+            }
+            leafPool.destroy(leaf);
+        } else {
+            innerPool.destroy(static_cast<Inner *>(child));
+        }
+        removeChild(inner, slot);
+    }
+    return true;
+}
+
+UserBTree::Record *UserBTree::find(int userId) {
+    return const_cast<Record *>(static_cast<const UserBTree *>(this)->find(userId));
+}
+
+const UserBTree::Record *UserBTree::find(int userId) const {
+    const Leaf *leaf = descend(userId);
+    if (leaf == nullptr) {
+        return nullptr;
+    }
+    const int pos = lowerSlot(leaf->keys, leaf->count, userId);
+    return (pos < leaf->count && leaf->keys[pos] == userId) ? &leaf->values[pos] : nullptr;
+}
+
+const UserBTree::Leaf *UserBTree::descend(int userId) const {
+    const Node *node = root;
+    if (node == nullptr) {
+        return nullptr;
+    }
+    while (!node->leaf) {
+        const Inner *inner = static_cast<const Inner *>(node);
+        node = inner->children[childSlot(inner->keys, inner->count, userId)];
+    }
+    return static_cast<const Leaf *>(node);
+}
+
+UserBTree::Cursor UserBTree::select(size_t k) const {
+    if (k >= count) {
+        return Cursor();
+    }
+    const Node *node = root;
+    while (!node->leaf) {
+        const Inner *inner = static_cast<const Inner *>(node);
+        int slot = 0;
+        while (k >= inner->sizes[slot]) {
+            k -= inner->sizes[slot];
+            slot++;
+        }
+        node = inner->children[slot];
+    }
+    return Cursor(static_cast<const Leaf *>(node), static_cast<int>(k));
+}
+
+UserBTree::Cursor UserBTree::lowerBound(int userId) const {
+    const Leaf *leaf = descend(userId);
+    if (leaf == nullptr) {
+        return Cursor();
+    }
+    const int pos = lowerSlot(leaf->keys, leaf->count, userId);
+    if (pos < leaf->count) {
+        return Cursor(leaf, pos);
+    }
+    // 比本叶子中的键都大：从下一个叶子的第一个键开始
+    return leaf->next != nullptr ? Cursor(leaf->next, 0) : Cursor();
+}
+
+size_t UserBTree::rank(int userId) const {
+    const Node *node = root;
+    if (node == nullptr) {
+        return 0;
+    }
+    size_t before = 0;
+    while (!node->leaf) {
+        const Inner *inner = static_cast<const Inner *>(node);
+        const int slot = childSlot(inner->keys, inner->count, userId);
+        for (int i = 0; i < slot; i++) {
+            before += inner->sizes[i];
+        }
+        node = inner->children[slot];
+    }
+    const Leaf *leaf = static_cast<const Leaf *>(node);
+    return before + static_cast<size_t>(lowerSlot(leaf->keys, leaf->count, userId));
+}
@@ -1,7 +1,44 @@
 #include "UserManager.h"
 
-UserManager::UserManager()
-    : root(nullptr), dataManager(nullptr), nextUserId(1000)
+namespace {
+    // 红黑树后端的快照：持有某个版本的树根，该版本的节点不再被修改
+    class TreeSnapshot : public UserSnapshotData {
+    public:
+        explicit TreeSnapshot(RBLink root) : root(std::move(root)) {}
+
+        [[nodiscard]] size_t size() const override { return root ? static_cast<size_t>(root->size) : 0; }
+
+        void forEach(const std::function<void(const UserData &)> &visit) const override {
+            for (auto cursor = UserRBTree::first(root.get()); cursor != UserRBTree::Cursor(); cursor.next()) {
+                visit(*cursor.record());
+            }
+        }
+
+    private:
+        RBLink root;
+    };
+
+    // B+ 树后端的快照：记录指针的副本
+    class RecordListSnapshot : public UserSnapshotData {
+    public:
+        explicit RecordListSnapshot(std::vector<std::shared_ptr<const UserData> > records)
+            : records(std::move(records)) {}
+
+        [[nodiscard]] size_t size() const override { return records.size(); }
+
+        void forEach(const std::function<void(const UserData &)> &visit) const override {
+            for (const auto &record : records) {
+                visit(*record);
+            }
+        }
+
+    private:
+        std::vector<std::shared_ptr<const UserData> > records;
+    };
+}
+
+UserManager::UserManager(UserIndexBackend backend)
+    : indexBackend(backend), dataManager(nullptr), nextUserId(1000)
 {
     dataManager = new DataManager();
     loadUsersFromDataManager();
@@ -9,42 +46,67 @@ UserManager::UserManager()
 
 UserManager::~UserManager()
 {
-    saveUsersToDataManager();
-    destroyTree(root);
     delete dataManager;
 }
 
+UserManager::const_iterator UserManager::begin() const
+{
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        return const_iterator(btree.begin());
+    }
+    return const_iterator(rbtree.begin());
+}
+
 // ========== QML 接口函数 ==========
 
 QVariantList UserManager::getAllUsers()
 {
-    QVariantList userList;
-    std::vector<UserData> users;
-    collectAllUsers(root, users);
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    return collectPage(0, userCount());
+}
 
-    // 按用户ID排序
-    std::sort(users.begin(), users.end(),
-        [](const UserData& a, const UserData& b) {
-            return a.userId < b.userId;
-        });
+QVariantList UserManager::getUsers(int offset, int limit)
+{
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    return collectPage(offset, limit);
+}
 
-    for (const auto& user : users) {
-        userList.append(userDataToVariantMap(user));
+QVariantList UserManager::collectPage(int offset, int limit) const
+{
+    QVariantList userList;
+    if (offset < 0 || limit <= 0) {
+        return userList;
+    }
+    userList.reserve(std::min(limit, std::max(0, userCount() - offset)));
+
+    // 索引按用户ID排序，顺序遍历即为升序，无需再排序
+    for (auto it = iteratorAt(offset); it != end() && userList.size() < limit; ++it) {
+        userList.append(userDataToVariantMap(*it));
     }
 
     return userList;
 }
 
-bool UserManager::addUser(const QString& username, const QString& password, bool isAdmin)
+int UserManager::getUserCount() const
 {
-    // 检查用户名是否已存在
-    if (searchUserByName(username.toStdString()) != nullptr) {
-        qDebug() << "用户名已存在: " << username;
-        return false;
-    }
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    return userCount();
+}
 
+int UserManager::getUserIndex(int userId) const
+{
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    const int index = static_cast<int>(indexBackend == UserIndexBackend::BPlusTree
+                                           ? btree.rank(userId)
+                                           : rbtree.rank(userId));
+    const_iterator it = iteratorAt(index);
+    return (it != end() && it->userId == userId) ? index : -1;
+}
+
+bool UserManager::addUser(const QString& username, const QString& password, bool isAdmin)
+{
+    // 盐与密码哈希在加锁前算好，写锁只覆盖查重与插入
     UserData newUser;
-    newUser.userId = nextUserId++;
     newUser.username = username.toStdString();
     newUser.salt = generateSalt().toStdString();
     newUser.password = hashPassword(password, QString::fromStdString(newUser.salt)).toStdString();
@@ -53,6 +115,15 @@ bool UserManager::addUser(const QString& username, const QString& password, bool
     newUser.viewHistory.clear();
     newUser.favorites.clear();
 
+    std::unique_lock<std::shared_mutex> lock(treeMutex);
+
+    // 检查用户名是否已存在
+    if (findUserByName(newUser.username) != nullptr) {
+        qDebug() << "用户名已存在: " << username;
+        return false;
+    }
+
+    newUser.userId = nextUserId++;
     if (insertUser(newUser)) {
         qDebug() << "成功添加用户: " << username;
         return true;
@@ -64,19 +135,20 @@ bool UserManager::addUser(const QString& username, const QString& password, bool
 
 bool UserManager::deleteUser(int userId)
 {
-    RBNode* user = searchUser(userId);
+    std::unique_lock<std::shared_mutex> lock(treeMutex);
+    const std::shared_ptr<const UserData>* user = findRecord(userId);
     if (user == nullptr) {
         qDebug() << "用户不存在，ID: " << userId;
         return false;
     }
 
     // 不允许删除管理员
-    if (user->userData.isAdmin) {
+    if ((*user)->isAdmin) {
         qDebug() << "不能删除管理员用户";
         return false;
     }
 
-    if (deleteUserNode(userId)) {
+    if (removeUser(userId)) {
         qDebug() << "成功删除用户，ID: " << userId;
         return true;
     }
@@ -87,7 +159,8 @@ bool UserManager::deleteUser(int userId)
 
 bool UserManager::updateUser(int userId, const QString& username, bool isAdmin)
 {
-    RBNode* user = searchUser(userId);
+    std::unique_lock<std::shared_mutex> lock(treeMutex);
+    const std::shared_ptr<const UserData>* user = findRecord(userId);
     if (user == nullptr) {
         qDebug() << "用户不存在，ID: " << userId;
         return false;
@@ -95,17 +168,23 @@ bool UserManager::updateUser(int userId, const QString& username, bool isAdmin)
 
     // 检查新用户名是否与其他用户冲突
     std::string newUsername = username.toStdString();
-    if (user->userData.username != newUsername) {
-        RBNode* existingUser = searchUserByName(newUsername);
+    if ((*user)->username != newUsername) {
+        const UserData* existingUser = findUserByName(newUsername);
         if (existingUser != nullptr && existingUser->userId != userId) {
             qDebug() << "用户名已被其他用户使用: " << username;
             return false;
         }
     }
 
-    // 更新用户信息
-    user->userData.username = newUsername;
-    user->userData.isAdmin = isAdmin;
+    // 更新用户信息：写时复制，已取出的快照仍看到旧记录；
+    // 旧记录先移出用户名索引与统计，新记录加入后再替换树中的记录
+    auto updated = std::make_shared<UserData>(**user);
+    updated->username = newUsername;
+    updated->isAdmin = isAdmin;
+
+    unindexUser(**user);
+    indexUser(*updated);
+    replaceRecord(std::move(updated));
 
     qDebug() << "成功更新用户，ID: " << userId;
     return true;
@@ -113,457 +192,242 @@ bool UserManager::updateUser(int userId, const QString& username, bool isAdmin)
 
 QVariantMap UserManager::getUserById(int userId)
 {
-    RBNode* user = searchUser(userId);
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    const std::shared_ptr<const UserData>* user = findRecord(userId);
     if (user != nullptr) {
-        return userDataToVariantMap(user->userData);
+        return userDataToVariantMap(**user);
     }
     return QVariantMap();
 }
 
 QVariantMap UserManager::getUserByName(const QString& username)
 {
-    RBNode* user = searchUserByName(username.toStdString());
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    const UserData* user = findUserByName(username.toStdString());
     if (user != nullptr) {
-        return userDataToVariantMap(user->userData);
+        return userDataToVariantMap(*user);
     }
     return QVariantMap();
 }
 
 QVariantMap UserManager::getUserStatistics()
 {
-    int totalUsers = 0;
-    int adminUsers = 0;
-    int regularUsers = 0;
-
-    calculateStatistics(root, totalUsers, adminUsers, regularUsers);
-
-    QVariantMap stats;
-    stats["totalUsers"] = totalUsers;
-    stats["adminUsers"] = adminUsers;
-    stats["regularUsers"] = regularUsers;
-
-    return stats;
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    QVariantMap result;
+    result["totalUsers"] = stats.totalUsers;
+    result["adminUsers"] = stats.adminUsers;
+    result["regularUsers"] = stats.totalUsers - stats.adminUsers;
+    result["activeUsers"] = stats.activeUsers;
+    result["cartItems"] = stats.cartItems;
+    result["cartQuantity"] = stats.cartQuantity;
+    result["browseItems"] = stats.browseItems;
+
+    return result;
 }
 
+/**
+ * @brief 保存全部用户到 users.json
+ *
+ * 读锁下只取快照（红黑树后端只复制树根，不复制用户数据），之后的遍历、序列化与写文件在后台持久化线程完成，
+ * 期间可以继续增删改用户。保存的是本实例中的用户记录，购物车等以加载时的数据为准
+ */
 bool UserManager::saveToFile()
 {
-    saveUsersToDataManager();
-    return true;
+    UserSnapshot users = snapshot();
+    std::lock_guard<std::mutex> dataLock(dataMutex);
+    bool saved = dataManager->saveUserSnapshot(users);
+    qDebug() << "已提交保存" << users->size() << "个用户:" << (saved ? "成功" : "失败");
+    return saved;
 }
 
+// 重新读取 users.json（会先等待已提交的保存完成）并重建用户索引
 bool UserManager::loadFromFile()
 {
+    {
+        std::lock_guard<std::mutex> dataLock(dataMutex);
+        if (!dataManager->loadUsersFromJson()) {
+            return false;
+        }
+    }
     loadUsersFromDataManager();
     return true;
 }
 
-void UserManager::refreshData()
+UserSnapshot UserManager::snapshot() const
 {
-    qDebug() << "刷新用户数据";
-}
-
-// ========== 红黑树操作函数 ==========
-
-RBNode* UserManager::newNode(const UserData& userData)
-{
-    RBNode* node = new RBNode;
-    node->userId = userData.userId;
-    node->userData = userData;
-    node->left = nullptr;
-    node->right = nullptr;
-    node->parent = nullptr;
-    node->color = RED;  // 新节点初始颜色为红色
-    return node;
+    std::shared_lock<std::shared_mutex> lock(treeMutex);
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        // B+ 树就地修改节点，不能共享，复制记录指针
+        std::vector<std::shared_ptr<const UserData> > records;
+        records.reserve(btree.size());
+        for (auto cursor = btree.begin(); cursor != UserBTree::Cursor(); cursor.next()) {
+            records.push_back(cursor.record());
+        }
+        return std::make_shared<const RecordListSnapshot>(std::move(records));
+    }
+    return std::make_shared<const TreeSnapshot>(rbtree.root());
 }
 
-void UserManager::leftRotate(RBNode** root, RBNode* x)
+void UserManager::refreshData()
 {
-    RBNode* y = x->right;
-    x->right = y->left;
-
-    if (y->left != nullptr)
-        y->left->parent = x;
-
-    y->parent = x->parent;
-
-    if (x->parent == nullptr)
-        *root = y;
-    else if (x == x->parent->left)
-        x->parent->left = y;
-    else
-        x->parent->right = y;
-
-    y->left = x;
-    x->parent = y;
+    qDebug() << "刷新用户数据";
 }
 
-void UserManager::rightRotate(RBNode** root, RBNode* y)
-{
-    RBNode* x = y->left;
-    y->left = x->right;
-
-    if (x->right != nullptr)
-        x->right->parent = y;
-
-    x->parent = y->parent;
-
-    if (y->parent == nullptr)
-        *root = x;
-    else if (y == y->parent->left)
-        y->parent->left = x;
-    else
-        y->parent->right = x;
+// ========== 索引操作（按后端分派） ==========
 
-    x->right = y;
-    y->parent = x;
-}
-
-void UserManager::insertFixup(RBNode** root, RBNode* z)
+bool UserManager::insertUser(const UserData& userData)
 {
-    while (z != *root && z->parent != nullptr && z->parent->color == RED) {
-        if (z->parent == z->parent->parent->left) {
-            RBNode* y = z->parent->parent->right;
-
-            if (y != nullptr && y->color == RED) {
-                // 情况1：叔节点为红色
-                z->parent->color = BLACK;
-                y->color = BLACK;
-                z->parent->parent->color = RED;
-                z = z->parent->parent;
-            } else {
-                if (z == z->parent->right) {
-                    // 情况2：z是右孩子
-                    z = z->parent;
-                    leftRotate(root, z);
-                }
-                // 情况3：z是左孩子
-                z->parent->color = BLACK;
-                z->parent->parent->color = RED;
-                rightRotate(root, z->parent->parent);
-            }
-        } else {
-            // 对称情况
-            RBNode *y = z->parent->parent->left;
-
-            if (y != nullptr && y->color == RED) {
-                z->parent->color = BLACK;
-                y->color = BLACK;
-                z->parent->parent->color = RED;
-                z = z->parent->parent;
-            } else {
-                if (z == z->parent->left) {
-                    z = z->parent;
-                    rightRotate(root, z);
-                }
-                z->parent->color = BLACK;
-                z->parent->parent->color = RED;
-                leftRotate(root, z->parent->parent);
-            }
-        }
+    auto record = std::make_shared<const UserData>(userData);
+    const UserData& user = *record;
+    bool inserted = indexBackend == UserIndexBackend::BPlusTree
+                        ? btree.insert(std::move(record))
+                        : rbtree.insert(std::move(record));
+    if (inserted) {
+        indexUser(user);
     }
-    (*root)->color = BLACK; // 根节点始终为黑色
+    return inserted;
 }
 
-bool UserManager::insertUser(const UserData& userData)
+bool UserManager::removeUser(int userId)
 {
-    // 检查用户是否已存在
-    if (searchUser(userData.userId) != nullptr) {
+    std::shared_ptr<const UserData> record = indexBackend == UserIndexBackend::BPlusTree
+                                                 ? btree.erase(userId)
+                                                 : rbtree.erase(userId);
+    if (record == nullptr) {
         return false;
     }
-
-    RBNode* z = newNode(userData);
-    RBNode* y = nullptr;
-    RBNode* x = root;
-
-    // 标准BST插入
-    while (x != nullptr) {
-        y = x;
-        if (z->userId < x->userId)
-            x = x->left;
-        else
-            x = x->right;
-    }
-
-    z->parent = y;
-
-    if (y == nullptr) // 插入的结点是根节点
-        root = z;
-    else if (z->userId < y->userId)
-        y->left = z;
-    else
-        y->right = z;
-
-    // 修复红黑树性质
-    insertFixup(&root, z);
+    unindexUser(*record);
     return true;
 }
 
-RBNode* UserManager::searchUser(int userId)
+const std::shared_ptr<const UserData>* UserManager::findRecord(int userId) const
 {
-    RBNode* current = root;
-    while (current != nullptr) {
-        if (userId == current->userId)
-            return current;
-        else if (userId < current->userId)
-            current = current->left;
-        else
-            current = current->right;
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        return btree.find(userId);
     }
-    return nullptr;
-}
-
-RBNode* UserManager::searchUserByName(const std::string& username)
-{
-    return searchUserByNameHelper(root, username);
+    return rbtree.find(userId);
 }
 
-RBNode* UserManager::searchUserByNameHelper(RBNode* node, const std::string& username)
+void UserManager::replaceRecord(std::shared_ptr<const UserData> record)
 {
-    if (node == nullptr) return nullptr;
-
-    if (node->userData.username == username) {
-        return node;
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        std::shared_ptr<const UserData>* slot = btree.find(record->userId);
+        if (slot != nullptr) {
+            *slot = std::move(record);
+        }
+        return;
     }
-
-    RBNode* leftResult = searchUserByNameHelper(node->left, username);
-    if (leftResult != nullptr) return leftResult;
-
-    return searchUserByNameHelper(node->right, username);
+    // 红黑树节点不可修改（可能被快照共享），只复制从根到该用户的路径
+    rbtree.replace(std::move(record));
 }
 
-RBNode* UserManager::minimum(RBNode* node)
+const UserData* UserManager::findUserByName(const std::string& username) const
 {
-    while (node->left != nullptr)
-        node = node->left;
-    return node;
+    const UserData* const* user = nameIndex.find(username);
+    return user != nullptr ? *user : nullptr;
 }
 
-void UserManager::deleteFixup(RBNode** root, RBNode* x, RBNode* xParent)
+int UserManager::userCount() const
 {
-    while (x != *root && (x == nullptr || x->color == BLACK)) {
-        if (x == xParent->left) {
-            RBNode* w = xParent->right;
-
-            if (w->color == RED) {
-                w->color = BLACK;
-                xParent->color = RED;
-                leftRotate(root, xParent);
-                w = xParent->right;
-            }
-
-            if ((w->left == nullptr || w->left->color == BLACK) &&
-                (w->right == nullptr || w->right->color == BLACK)) {
-                w->color = RED;
-                x = xParent;
-                xParent = x->parent;
-            } else {
-                if (w->right == nullptr || w->right->color == BLACK) {
-                    if (w->left != nullptr)
-                        w->left->color = BLACK;
-                    w->color = RED;
-                    rightRotate(root, w);
-                    w = xParent->right;
-                }
-
-                w->color = xParent->color;
-                xParent->color = BLACK;
-                if (w->right != nullptr)
-                    w->right->color = BLACK;
-                leftRotate(root, xParent);
-                x = *root;
-                break;
-            }
-        } else {
-            RBNode *w = xParent->left;
-
-            if (w->color == RED) {
-                w->color = BLACK;
-                xParent->color = RED;
-                rightRotate(root, xParent);
-                w = xParent->left;
-            }
-
-            if ((w->right == nullptr || w->right->color == BLACK) &&
-                (w->left == nullptr || w->left->color == BLACK)) {
-                w->color = RED;
-                x = xParent;
-                xParent = x->parent;
-            } else {
-                if (w->left == nullptr || w->left->color == BLACK) {
-                    if (w->right != nullptr)
-                        w->right->color = BLACK;
-                    w->color = RED;
-                    leftRotate(root, w);
-                    w = xParent->left;
-                }
-
-                w->color = xParent->color;
-                xParent->color = BLACK;
-                if (w->left != nullptr)
-                    w->left->color = BLACK;
-                rightRotate(root, xParent);
-                x = *root;
-                break;
-            }
-        }
-    }
-
-    if (x != nullptr)
-        x->color = BLACK;
+    return static_cast<int>(indexBackend == UserIndexBackend::BPlusTree ? btree.size() : rbtree.size());
 }
 
-bool UserManager::deleteUserNode(int userId)
+UserManager::const_iterator UserManager::iteratorAt(int k) const
 {
-    RBNode* z = searchUser(userId);
-    if (z == nullptr) {
-        return false;
+    if (k < 0) {
+        return end();
     }
-
-    RBNode* y = z;
-    RBNode* x = nullptr;
-    RBNode* xParent = nullptr;
-    Color yOriginalColor = y->color;
-
-    if (z->left == nullptr) {
-        x = z->right;
-        xParent = z->parent;
-
-        if (z->parent == nullptr)
-            root = z->right;
-        else if (z == z->parent->left)
-            z->parent->left = z->right;
-        else
-            z->parent->right = z->right;
-
-        if (z->right != nullptr)
-            z->right->parent = z->parent;
-    } else if (z->right == nullptr) {
-        x = z->left;
-        xParent = z->parent;
-
-        if (z->parent == nullptr)
-            root = z->left;
-        else if (z == z->parent->left)
-            z->parent->left = z->left;
-        else
-            z->parent->right = z->left;
-
-        if (z->left != nullptr)
-            z->left->parent = z->parent;
-    } else {
-        y = minimum(z->right);
-        yOriginalColor = y->color;
-        x = y->right;
-
-        if (y->parent == z) {
-            if (x != nullptr)
-                x->parent = y;
-            xParent = y;
-        } else {
-            xParent = y->parent;
-
-            if (y->parent != nullptr) {
-                if (y == y->parent->left)
-                    y->parent->left = y->right;
-                else
-                    y->parent->right = y->right;
-            }
-
-            if (y->right != nullptr)
-                y->right->parent = y->parent;
-
-            y->right = z->right;
-            if (z->right != nullptr)
-                z->right->parent = y;
-        }
-
-        if (z->parent == nullptr)
-            root = y;
-        else if (z == z->parent->left)
-            z->parent->left = y;
-        else
-            z->parent->right = y;
-
-        y->parent = z->parent;
-        y->left = z->left;
-        if (z->left != nullptr)
-            z->left->parent = y;
-        y->color = z->color;
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        return const_iterator(btree.select(static_cast<size_t>(k)));
     }
+    return const_iterator(rbtree.select(static_cast<size_t>(k)));
+}
 
-    delete z;
-
-    if (yOriginalColor == BLACK)
-        deleteFixup(&root, x, xParent);
-
-    return true;
+void UserManager::clearUsers()
+{
+    rbtree.clear();
+    btree.clear();
+    nameIndex.clear();
+    stats = UserStatistics();
 }
 
-void UserManager::collectAllUsers(RBNode* node, std::vector<UserData>& users)
+// 用户名重复时索引保留先加入的用户
+void UserManager::indexUser(const UserData& user)
 {
-    if (node != nullptr) {
-        collectAllUsers(node->left, users);
-        users.push_back(node->userData);
-        collectAllUsers(node->right, users);
+    if (!nameIndex.contains(user.username)) {
+        nameIndex.insert(user.username, &user);
     }
+    accountUser(user, 1);
 }
 
-void UserManager::calculateStatistics(RBNode* node, int& total, int& admin, int& regular)
+void UserManager::unindexUser(const UserData& user)
 {
-    if (node != nullptr) {
-        total++;
-        if (node->userData.isAdmin) {
-            admin++;
-        } else {
-            regular++;
-        }
-        calculateStatistics(node->left, total, admin, regular);
-        calculateStatistics(node->right, total, admin, regular);
+    const UserData** indexed = nameIndex.find(user.username);
+    if (indexed != nullptr && *indexed == &user) {
+        nameIndex.erase(user.username);
     }
+    accountUser(user, -1);
 }
 
-void UserManager::destroyTree(RBNode* node)
+void UserManager::accountUser(const UserData& user, int sign)
 {
-    if (node) {
-        destroyTree(node->left);
-        destroyTree(node->right);
-        delete node;
+    stats.totalUsers += sign;
+    if (user.isAdmin) {
+        stats.adminUsers += sign;
+    }
+    if (!user.shoppingCart.empty() || !user.viewHistory.empty()) {
+        stats.activeUsers += sign;
     }
+    stats.cartItems += sign * static_cast<long long>(user.shoppingCart.size());
+    stats.cartQuantity += sign * user.shoppingCart.totalValue();
+    stats.browseItems += sign * static_cast<long long>(user.viewHistory.size());
 }
 
 // ========== 数据管理函数 ==========
 
 void UserManager::loadUsersFromDataManager()
 {
-    // 清空现有红黑树
-    destroyTree(root);
-    root = nullptr;
+    std::unique_lock<std::shared_mutex> lock(treeMutex);
+    std::lock_guard<std::mutex> dataLock(dataMutex);
+
+    // 清空现有索引
+    clearUsers();
 
     auto& users = dataManager->getUsers();
+    std::vector<const UserData*> sorted;
+    sorted.reserve(users.size());
     for (const auto& user : users) {
-        insertUser(user);
+        sorted.push_back(&user);
         if (user.userId >= nextUserId) {
             nextUserId = user.userId + 1;
         }
     }
 
-    qDebug() << "已从DataManager加载" << users.size() << "个用户到红黑树";
-}
-
-void UserManager::saveUsersToDataManager()
-{
-    std::vector<UserData> users;
-    collectAllUsers(root, users);
-
-    // 清空DataManager中的用户数据并重新添加
-    auto& managerUsers = dataManager->getUsers();
-    managerUsers.clear();
+    // 按用户ID排序（已有序时跳过），同一ID只保留第一条，与逐个插入时的结果一致
+    auto byId = [](const UserData* a, const UserData* b) { return a->userId < b->userId; };
+    if (!std::is_sorted(sorted.begin(), sorted.end(), byId)) {
+        std::stable_sort(sorted.begin(), sorted.end(), byId);
+    }
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                             [](const UserData* a, const UserData* b) { return a->userId == b->userId; }),
+                 sorted.end());
+
+    std::vector<std::shared_ptr<const UserData> > records;
+    records.reserve(sorted.size());
+    nameIndex.reserve(sorted.size());
+    for (const UserData* user : sorted) {
+        records.push_back(std::make_shared<const UserData>(*user));
+        indexUser(*records.back());
+    }
 
-    for (const auto& user : users) {
-        dataManager->addUser(user);
+    if (indexBackend == UserIndexBackend::BPlusTree) {
+        btree.build(records);
+    } else {
+        rbtree.build(records);
     }
 
-    qDebug() << "已将" << users.size() << "个用户数据保存到DataManager";
+    qDebug() << "已从DataManager加载" << users.size() << "个用户到"
+             << (indexBackend == UserIndexBackend::BPlusTree ? "B+树" : "红黑树");
 }
 
 // ========== 辅助函数 ==========
@@ -0,0 +1,321 @@
+#include "UserRBTree.h"
+#include "DataManager.h"
+#include "NodePool.h"
+#include <mutex>
+
+namespace {
+// 所有树共用的节点池：快照可能在其他线程中释放最后一个引用，因此由互斥锁保护。
+// 池本身不析构，程序退出时晚于它析构的树仍可归还节点
+struct SharedNodePool {
+    std::mutex mutex;
+    NodePool<RBNode> nodes;
+};
+
+SharedNodePool &nodePool() {
+    static SharedNodePool *pool = new SharedNodePool();
+    return *pool;
+}
+
+// 节点一经建立不再修改，以下函数都返回新节点，参数中的子树原样共享
+
+int sizeOf(const RBNode *node) {
+    return node ? node->size : 0;
+}
+
+bool isRed(const RBNode *node) {
+    return node && node->color == RED;
+}
+
+// 非空的黑节点
+bool isBlack(const RBNode *node) {
+    return node && node->color == BLACK;
+}
+
+RBLink makeNode(Color color, RBLink left, UserRBTree::Record record, RBLink right) {
+    const int userId = record->userId;
+    const int size = sizeOf(left.get()) + sizeOf(right.get()) + 1;
+    RBNode *node;
+    {
+        SharedNodePool &pool = nodePool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        node = pool.nodes.create();
+    }
+    node->userId = userId;
+    node->size = size;
+    node->left = left.detach(); // 新节点接手 left、right 的引用
+    node->right = right.detach();
+    node->color = color;
+    node->refs.store(0, std::memory_order_relaxed);
+    node->userData = std::move(record);
+    return RBLink(node);
+}
+
+RBLink recolor(const RBNode *node, Color color) {
+    return node->color == color ? RBLink(node) : makeNode(color, RBLink(node->left), node->userData, RBLink(node->right));
+}
+
+// 黑节点 record 的左右子树之一出现连续红节点时重新平衡（插入、删除共用）
+RBLink balance(RBLink left, UserRBTree::Record record, RBLink right) {
+    if (isRed(left.get()) && isRed(right.get())) {
+        return makeNode(RED, recolor(left.get(), BLACK), std::move(record), recolor(right.get(), BLACK));
+    }
+    if (isRed(left.get()) && isRed(left->left)) {
+        return makeNode(RED, recolor(left->left, BLACK), left->userData,
+                        makeNode(BLACK, RBLink(left->right), std::move(record), std::move(right)));
+    }
+    if (isRed(left.get()) && isRed(left->right)) {
+        const RBNode *middle = left->right;
+        return makeNode(RED, makeNode(BLACK, RBLink(left->left), left->userData, RBLink(middle->left)), middle->userData,
+                        makeNode(BLACK, RBLink(middle->right), std::move(record), std::move(right)));
+    }
+    if (isRed(right.get()) && isRed(right->right)) {
+        return makeNode(RED, makeNode(BLACK, std::move(left), std::move(record), RBLink(right->left)), right->userData,
+                        recolor(right->right, BLACK));
+    }
+    if (isRed(right.get()) && isRed(right->left)) {
+        const RBNode *middle = right->left;
+        return makeNode(RED, makeNode(BLACK, std::move(left), std::move(record), RBLink(middle->left)), middle->userData,
+                        makeNode(BLACK, RBLink(middle->right), right->userData, RBLink(right->right)));
+    }
+    return makeNode(BLACK, std::move(left), std::move(record), std::move(right));
+}
+
+RBLink insertInto(const RBNode *node, UserRBTree::Record &record, bool &inserted) {
+    if (!node) {
+        inserted = true;
+        return makeNode(RED, RBLink(), std::move(record), RBLink());
+    }
+    const int userId = record->userId;
+    if (userId == node->userId) {
+        return RBLink(node);
+    }
+    if (userId < node->userId) {
+        RBLink left = insertInto(node->left, record, inserted);
+        if (!inserted) {
+            return RBLink(node);
+        }
+        return node->color == BLACK ? balance(std::move(left), node->userData, RBLink(node->right))
+                                    : makeNode(RED, std::move(left), node->userData, RBLink(node->right));
+    }
+    RBLink right = insertInto(node->right, record, inserted);
+    if (!inserted) {
+        return RBLink(node);
+    }
+    return node->color == BLACK ? balance(RBLink(node->left), node->userData, std::move(right))
+                                : makeNode(RED, RBLink(node->left), node->userData, std::move(right));
+}
+
+// 左子树黑高比右子树少一时恢复平衡
+RBLink balanceLeft(RBLink left, UserRBTree::Record record, const RBNode *right) {
+    if (isRed(left.get())) {
+        return makeNode(RED, recolor(left.get(), BLACK), std::move(record), RBLink(right));
+    }
+    if (isBlack(right)) {
+        return balance(std::move(left), std::move(record), recolor(right, RED));
+    }
+    // right 为红，其左孩子为黑
+    const RBNode *middle = right->left;
+    return makeNode(RED, makeNode(BLACK, std::move(left), std::move(record), RBLink(middle->left)), middle->userData,
+                    balance(RBLink(middle->right), right->userData, recolor(right->right, RED)));
+}
+
+// 右子树黑高比左子树少一时恢复平衡
+RBLink balanceRight(const RBNode *left, UserRBTree::Record record, RBLink right) {
+    if (isRed(right.get())) {
+        return makeNode(RED, RBLink(left), std::move(record), recolor(right.get(), BLACK));
+    }
+    if (isBlack(left)) {
+        return balance(recolor(left, RED), std::move(record), std::move(right));
+    }
+    // left 为红，其右孩子为黑
+    const RBNode *middle = left->right;
+    return makeNode(RED, balance(recolor(left->left, RED), left->userData, RBLink(middle->left)), middle->userData,
+                    makeNode(BLACK, RBLink(middle->right), std::move(record), std::move(right)));
+}
+
+// 合并被删除节点的左右子树（left 中的键都小于 right 中的键，两者黑高相同）
+RBLink fuse(const RBNode *left, const RBNode *right) {
+    if (!left) {
+        return RBLink(right);
+    }
+    if (!right) {
+        return RBLink(left);
+    }
+    if (isRed(left) && isRed(right)) {
+        RBLink inner = fuse(left->right, right->left);
+        if (isRed(inner.get())) {
+            return makeNode(RED, makeNode(RED, RBLink(left->left), left->userData, RBLink(inner->left)), inner->userData,
+                            makeNode(RED, RBLink(inner->right), right->userData, RBLink(right->right)));
+        }
+        return makeNode(RED, RBLink(left->left), left->userData,
+                        makeNode(RED, std::move(inner), right->userData, RBLink(right->right)));
+    }
+    if (isBlack(left) && isBlack(right)) {
+        RBLink inner = fuse(left->right, right->left);
+        if (isRed(inner.get())) {
+            return makeNode(RED, makeNode(BLACK, RBLink(left->left), left->userData, RBLink(inner->left)), inner->userData,
+                            makeNode(BLACK, RBLink(inner->right), right->userData, RBLink(right->right)));
+        }
+        RBLink merged = makeNode(BLACK, std::move(inner), right->userData, RBLink(right->right));
+        return balanceLeft(RBLink(left->left), left->userData, merged.get());
+    }
+    if (isRed(right)) {
+        return makeNode(RED, fuse(left, right->left), right->userData, RBLink(right->right));
+    }
+    return makeNode(RED, RBLink(left->left), left->userData, fuse(left->right, right));
+}
+
+// 调用方保证 userId 在树中
+RBLink eraseFrom(const RBNode *node, int userId, UserRBTree::Record &removed) {
+    if (userId < node->userId) {
+        RBLink left = eraseFrom(node->left, userId, removed);
+        return isBlack(node->left) ? balanceLeft(std::move(left), node->userData, node->right)
+                                   : makeNode(RED, std::move(left), node->userData, RBLink(node->right));
+    }
+    if (userId > node->userId) {
+        RBLink right = eraseFrom(node->right, userId, removed);
+        return isBlack(node->right) ? balanceRight(node->left, node->userData, std::move(right))
+                                    : makeNode(RED, RBLink(node->left), node->userData, std::move(right));
+    }
+    removed = node->userData;
+    return fuse(node->left, node->right);
+}
+
+RBLink replaceIn(const RBNode *node, UserRBTree::Record &record) {
+    const int userId = record->userId;
+    if (userId < node->userId) {
+        return makeNode(node->color, replaceIn(node->left, record), node->userData, RBLink(node->right));
+    }
+    if (userId > node->userId) {
+        return makeNode(node->color, RBLink(node->left), node->userData, replaceIn(node->right, record));
+    }
+    return makeNode(node->color, RBLink(node->left), std::move(record), RBLink(node->right));
+}
+
+/**
+ * 每次取区间中点为根，左右子树节点数至多差一，除最底层外各层都是满的。
+ * 最底层（深度 floor(log2 n)）染红、其余染黑，每条路径的黑节点数相同；
+ * 只有一个节点时它就是根，保持黑色
+ */
+RBLink linkBalanced(const std::vector<UserRBTree::Record> &sorted, size_t begin, size_t end, int depth, int redDepth) {
+    if (begin >= end) {
+        return RBLink();
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    RBLink left = linkBalanced(sorted, begin, mid, depth + 1, redDepth);
+    RBLink right = linkBalanced(sorted, mid + 1, end, depth + 1, redDepth);
+    const Color color = (depth == redDepth && depth > 0) ? RED : BLACK;
+    return makeNode(color, std::move(left), sorted[mid], std::move(right));
+}
+} // namespace
+
+/**
+ * 最后一个引用释放时回收整棵不再被引用的子树：逐层向下释放孩子的引用，收集计数归零的节点
+ * （不递归，整棵树被丢弃时也不会栈溢出），先在锁外释放各节点的记录，再一次加锁全部归还节点池。
+ * 池中已没有存活节点时（如重新加载前丢弃了唯一的树），池从头按地址顺序重新分配
+ */
+void RBLink::release(const RBNode *node) {
+    if (node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::vector<RBNode *> dead{const_cast<RBNode *>(node)}; // 节点都来自节点池，本身并非常量
+    for (size_t i = 0; i < dead.size(); i++) {
+        for (const RBNode *child : {dead[i]->left, dead[i]->right}) {
+            if (child != nullptr && child->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                dead.push_back(const_cast<RBNode *>(child));
+            }
+        }
+        dead[i]->userData.reset();
+    }
+
+    SharedNodePool &pool = nodePool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (RBNode *deadNode : dead) {
+        pool.nodes.destroy(deadNode);
+    }
+    pool.nodes.clear();
+}
+
+void UserRBTree::build(const std::vector<Record> &sorted) {
+    int redDepth = 0;
+    while ((size_t(2) << redDepth) <= sorted.size()) {
+        redDepth++;
+    }
+    top = linkBalanced(sorted, 0, sorted.size(), 0, redDepth);
+}
+
+bool UserRBTree::insert(Record record) {
+    bool inserted = false;
+    RBLink updated = insertInto(top.get(), record, inserted);
+    if (inserted) {
+        top = recolor(updated.get(), BLACK); // 根节点始终为黑色
+    }
+    return inserted;
+}
+
+UserRBTree::Record UserRBTree::erase(int userId) {
+    Record removed;
+    if (find(userId) == nullptr) {
+        return removed;
+    }
+    RBLink updated = eraseFrom(top.get(), userId, removed);
+    top = updated ? recolor(updated.get(), BLACK) : RBLink();
+    return removed;
+}
+
+bool UserRBTree::replace(Record record) {
+    if (find(record->userId) == nullptr) {
+        return false;
+    }
+    top = replaceIn(top.get(), record);
+    return true;
+}
+
+const UserRBTree::Record *UserRBTree::find(int userId) const {
+    const RBNode *node = top.get();
+    while (node != nullptr) {
+        if (userId == node->userId)
+            return &node->userData;
+        node = userId < node->userId ? node->left : node->right;
+    }
+    return nullptr;
+}
+
+UserRBTree::Cursor UserRBTree::first(const RBNode *node) {
+    Cursor cursor;
+    cursor.pushLeft(node);
+    return cursor;
+}
+
+UserRBTree::Cursor UserRBTree::select(size_t k) const {
+    Cursor cursor;
+    const RBNode *node = top.get();
+    while (node != nullptr) {
+        const size_t leftSize = static_cast<size_t>(sizeOf(node->left));
+        if (k < leftSize) {
+            cursor.push(node); // 之后还要回到这里
+            node = node->left;
+        } else if (k == leftSize) {
+            cursor.push(node);
+            return cursor;
+        } else {
+            k -= leftSize + 1;
+            node = node->right;
+        }
+    }
+    return Cursor();
+}
+
+size_t UserRBTree::rank(int userId) const {
+    size_t smaller = 0;
+    const RBNode *node = top.get();
+    while (node != nullptr) {
+        if (userId <= node->userId) {
+            node = node->left;
+        } else {
+            smaller += static_cast<size_t>(sizeOf(node->left)) + 1;
+            node = node->right;
+        }
+    }
+    return smaller;
+}
@@ -1,5 +1,11 @@
 #include <QtGui/QGuiApplication>
 #include <QtQml>
+#include <QAbstractListModel>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+#include <cmath>
 #include "StateManager.h"
 #include "DataManager.h"
 #include "UserManager.h"
@@ -85,12 +91,9 @@ public:
         emit stateChanged(getCurrentState());
     }
 
+    // 权限取自当前会话，不查找用户
     Q_INVOKABLE bool isCurrentUserAdmin() {
-        QString currentUser = getCurrentUser();
-        if (!currentUser.isEmpty()) {
-            return ::isCurrentUserAdmin(currentUser.toStdString());
-        }
-        return false;
+        return ::isCurrentSessionAdmin();
     }
 
     // 新增：获取用户对商品的评分
@@ -106,15 +109,8 @@ public:
             return -1;
         }
 
-        // 在用户的 favorites 中查找该商品的评分
-        // favorites 格式: [[productId, rating], ...]
-        for (const auto& entry : user->favorites) {
-            if (entry.size() >= 2 && entry[0] == productId) {
-                return entry[1]; // 返回评分
-            }
-        }
-
-        return -1; // 未找到评分
+        // 在用户的 favorites 中查找该商品的评分，未找到返回 -1
+        return user->favorites.valueOf(productId, -1);
     }
 
     // 获取用户统计数据 - 修正浏览历史统计逻辑
@@ -134,20 +130,10 @@ public:
 
         if (user) {
             // 计算购物车商品数量（所有商品的数量总和）
-            int cartItemCount = 0;
-            for (const auto& entry : user->shoppingCart) {
-                if (entry.size() >= 2) {
-                    cartItemCount += entry[1];  // entry[1] 是数量
-                }
-            }
+            int cartItemCount = static_cast<int>(user->shoppingCart.totalValue());
 
             // 计算浏览历史总次数（累加每个商品的浏览次数）
-            int historyItemCount = 0;
-            for (const auto& entry : user->viewHistory) {
-                if (entry.size() >= 2) {
-                    historyItemCount += entry[1];  // entry[1] 是浏览次数
-                }
-            }
+            int historyItemCount = static_cast<int>(user->viewHistory.totalValue());
 
             // 计算收藏商品数量
             int favoritesCount = user->favorites.size();
@@ -177,8 +163,8 @@ public:
         bool success = dataManager.addToCart(currentUser.toStdString(), productId, quantity);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "添加购物车成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -196,8 +182,8 @@ public:
         bool success = dataManager.removeFromCart(currentUser.toStdString(), productId);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "从购物车移除成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -215,8 +201,8 @@ public:
         bool success = dataManager.updateCartQuantity(currentUser.toStdString(), productId, newQuantity);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "更新购物车数量成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -236,8 +222,8 @@ public:
         bool success = dataManager.addViewHistory(currentUser.toStdString(), productId);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "添加浏览历史成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -256,8 +242,8 @@ public:
         bool success = dataManager.addToFavorites(currentUser.toStdString(), productId, rating);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "添加收藏成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -275,8 +261,8 @@ public:
         bool success = dataManager.removeFromFavorites(currentUser.toStdString(), productId);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = dataManager.saveDirtyUsers();
             qDebug() << "移除收藏成功 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -301,7 +287,7 @@ public:
         
         if (success) {
             // 评价成功后立即保存用户数据和商品数据
-            bool userSaved = dataManager.saveUsersToJson();
+            bool userSaved = dataManager.saveDirtyUsers();
             bool productSaved = dataManager.saveProductsToJson();
             
             qDebug() << "商品评价成功 - 用户数据保存:" << (userSaved ? "成功" : "失败") 
@@ -315,30 +301,822 @@ signals:
     void stateChanged(int newState);
 };
 
+// 排序字段名 -> ProductSortKey，未知名称按价格
+static ProductSortKey toSortKey(const QString& name) {
+    if (name == "avgRating") return ProductSortKey::AvgRating;
+    if (name == "reviewers") return ProductSortKey::Reviewers;
+    if (name == "stock") return ProductSortKey::Stock;
+    return ProductSortKey::Price;
+}
+
+/**
+ * @brief 商品浏览列表模型
+ *
+ * - 查询条件（关键词、分类、价格区间、库存、排序）作为属性，修改后自动重新查询
+ * - 只保存命中商品在 DataManager 商品容器中的下标，data() 按行读取商品，
+ *   视图只会读取可见的行
+ * - 行按 pageSize 分批暴露给视图：滚动到末尾时视图调用 fetchMore() 再追加一批
+ * - 条件变化时按行比较新旧结果，只对变化的部分发出增删通知
+ * - 查询在后台线程执行：关键词变化先防抖，其余条件变化立即查询；
+ *   每次查询带一个递增的代号，只有最新一次查询的结果会被应用，过时的查询在开始前或结束后被丢弃
+ * - 商品容器被整体替换（重新加载）后须调用 refresh(true)；修改商品容器前须先持有 lockCatalog()
+ * - 查询索引在第一次查询时才建立，在主线程直接调用 DataManager 查询接口时同样须持有 lockCatalog()
+ */
+class ProductListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(QString keyword READ keyword WRITE setKeyword NOTIFY keywordChanged)
+    Q_PROPERTY(QString category READ category WRITE setCategory NOTIFY categoryChanged)
+    Q_PROPERTY(double minPrice READ minPrice WRITE setMinPrice NOTIFY minPriceChanged)
+    Q_PROPERTY(double maxPrice READ maxPrice WRITE setMaxPrice NOTIFY maxPriceChanged)
+    Q_PROPERTY(bool inStockOnly READ inStockOnly WRITE setInStockOnly NOTIFY inStockOnlyChanged)
+    Q_PROPERTY(QString sortKey READ sortKey WRITE setSortKey NOTIFY sortKeyChanged)
+    Q_PROPERTY(bool descending READ descending WRITE setDescending NOTIFY descendingChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY resultsChanged)
+    Q_PROPERTY(QVariantMap categoryCounts READ categoryCounts NOTIFY resultsChanged)
+    Q_PROPERTY(int inStockCount READ inStockCount NOTIFY resultsChanged)
+    Q_PROPERTY(int outOfStockCount READ outOfStockCount NOTIFY resultsChanged)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+
+public:
+    enum Roles {
+        ProductIdRole = Qt::UserRole + 1,
+        NameRole,
+        PriceRole,
+        StockRole,
+        CategoryRole,
+        AvgRatingRole,
+        ReviewersRole
+    };
+
+    explicit ProductListModel(DataManager& dataManager, QObject* parent = nullptr)
+        : QAbstractListModel(parent), m_dataManager(dataManager) {
+        // 查询串行执行：同一时刻只有一个查询读取商品容器，排队中的过时查询直接跳过
+        m_queryPool.setMaxThreadCount(1);
+        m_debounce.setSingleShot(true);
+        m_debounce.setInterval(kDebounceMs);
+        connect(&m_debounce, &QTimer::timeout, this, &ProductListModel::queryNow);
+    }
+
+    ~ProductListModel() override {
+        ++m_generation;
+        m_queryPool.waitForDone();
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(m_loaded);
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        const ProductData* product = productAt(index.row());
+        if (!product) {
+            return QVariant();
+        }
+
+        switch (role) {
+            case ProductIdRole: return product->productId;
+            case NameRole: return product->name.toQString();
+            case PriceRole: return product->price;
+            case StockRole: return product->stock;
+            case CategoryRole: return product->category.toQString();
+            case AvgRatingRole: return product->avgRating;
+            case ReviewersRole: return product->reviewers;
+            default: return QVariant();
+        }
+    }
+
+    QHash<int, QByteArray> roleNames() const override {
+        return {
+            {ProductIdRole, "productId"},
+            {NameRole, "name"},
+            {PriceRole, "price"},
+            {StockRole, "stock"},
+            {CategoryRole, "category"},
+            {AvgRatingRole, "avgRating"},
+            {ReviewersRole, "reviewers"}
+        };
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override {
+        return !parent.isValid() && m_loaded < m_matches.size();
+    }
+
+    void fetchMore(const QModelIndex& parent) override {
+        if (parent.isValid() || m_loaded >= m_matches.size()) {
+            return;
+        }
+        const size_t next = std::min(m_matches.size(), m_loaded + static_cast<size_t>(m_pageSize));
+        beginInsertRows(QModelIndex(), static_cast<int>(m_loaded), static_cast<int>(next) - 1);
+        m_loaded = next;
+        endInsertRows();
+        emit countChanged();
+    }
+
+    QString keyword() const { return m_keyword; }
+    QString category() const { return m_category; }
+    double minPrice() const { return m_minPrice; }
+    double maxPrice() const { return m_maxPrice; }
+    bool inStockOnly() const { return m_inStockOnly; }
+    QString sortKey() const { return m_sortKey; }
+    bool descending() const { return m_descending; }
+    int pageSize() const { return m_pageSize; }
+    int count() const { return static_cast<int>(m_loaded); }
+    int totalCount() const { return static_cast<int>(m_matches.size()); }
+    QVariantMap categoryCounts() const { return m_categoryCounts; }
+    int inStockCount() const { return m_inStockCount; }
+    int outOfStockCount() const { return m_outOfStockCount; }
+    bool busy() const { return m_busy; }
+
+    // 关键词随输入逐字变化，等输入停顿后再查询
+    void setKeyword(const QString& value) {
+        if (m_keyword == value) return;
+        m_keyword = value;
+        emit keywordChanged();
+        m_debounce.start();
+    }
+
+    void setCategory(const QString& value) {
+        if (m_category == value) return;
+        m_category = value;
+        emit categoryChanged();
+        queryNow();
+    }
+
+    void setMinPrice(double value) {
+        if (m_minPrice == value) return;
+        m_minPrice = value;
+        emit minPriceChanged();
+        queryNow();
+    }
+
+    void setMaxPrice(double value) {
+        if (m_maxPrice == value) return;
+        m_maxPrice = value;
+        emit maxPriceChanged();
+        queryNow();
+    }
+
+    void setInStockOnly(bool value) {
+        if (m_inStockOnly == value) return;
+        m_inStockOnly = value;
+        emit inStockOnlyChanged();
+        queryNow();
+    }
+
+    void setSortKey(const QString& value) {
+        if (m_sortKey == value) return;
+        m_sortKey = value;
+        emit sortKeyChanged();
+        queryNow();
+    }
+
+    void setDescending(bool value) {
+        if (m_descending == value) return;
+        m_descending = value;
+        emit descendingChanged();
+        queryNow();
+    }
+
+    void setPageSize(int value) {
+        value = std::max(value, 1);
+        if (m_pageSize == value) return;
+        m_pageSize = value;
+        emit pageSizeChanged();
+    }
+
+    /**
+     * @brief 在后台线程按当前条件查询，跳过防抖等待
+     *
+     * 结果通过队列连接回到主线程应用；应用前再核对代号，期间又发起过查询则丢弃
+     */
+    Q_INVOKABLE void queryNow() {
+        m_debounce.stop();
+        const uint64_t generation = ++m_generation;
+        const QuerySpec spec = currentSpec();
+        setBusy(true);
+
+        m_queryPool.start([this, generation, spec]() {
+            if (generation != m_generation.load()) {
+                return; // 排队期间已有更新的查询
+            }
+            ProductQueryResult result;
+            {
+                std::lock_guard<std::mutex> lock(m_catalogMutex);
+                if (generation != m_generation.load()) {
+                    return;
+                }
+                result = runQuery(spec);
+            }
+            QMetaObject::invokeMethod(this, [this, generation, result = std::move(result)]() mutable {
+                if (generation != m_generation.load()) {
+                    return;
+                }
+                applyResult(std::move(result), false);
+                setBusy(false);
+                emit queryFinished(totalCount());
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    /**
+     * @brief 在主线程按当前条件立即查询，并作废所有尚未应用的后台查询
+     * @param catalogChanged 商品容器被重新加载过：保留下来的行也要通知视图重新读取
+     */
+    Q_INVOKABLE void refresh(bool catalogChanged = false) {
+        m_debounce.stop();
+        ++m_generation;
+        ProductQueryResult result;
+        {
+            std::lock_guard<std::mutex> lock(m_catalogMutex);
+            result = runQuery(currentSpec());
+        }
+        applyResult(std::move(result), catalogChanged);
+        setBusy(false);
+        emit queryFinished(totalCount());
+    }
+
+    // 修改商品容器期间持有：等待正在执行的后台查询结束，并阻止新的查询读取
+    std::unique_lock<std::mutex> lockCatalog() {
+        return std::unique_lock<std::mutex>(m_catalogMutex);
+    }
+
+    // 商品的评分、库存等字段变化后调用，只通知对应的行重新读取
+    void productChanged(int productId) {
+        const ProductData* product = m_dataManager.findProduct(productId);
+        if (!product) {
+            return;
+        }
+        const size_t slot = static_cast<size_t>(product - m_dataManager.getProducts().data());
+        for (size_t row = 0; row < m_loaded; row++) {
+            if (m_matches[row] == slot) {
+                const QModelIndex changed = index(static_cast<int>(row));
+                emit dataChanged(changed, changed);
+                return;
+            }
+        }
+    }
+
+    // 第 row 行的商品；行号越界或商品容器已变化时返回 nullptr
+    const ProductData* productAt(int row) const {
+        if (row < 0 || static_cast<size_t>(row) >= m_loaded) {
+            return nullptr;
+        }
+        const auto& products = m_dataManager.getProducts();
+        const size_t slot = m_matches[static_cast<size_t>(row)];
+        return slot < products.size() ? &products[slot] : nullptr;
+    }
+
+signals:
+    void keywordChanged();
+    void categoryChanged();
+    void minPriceChanged();
+    void maxPriceChanged();
+    void inStockOnlyChanged();
+    void sortKeyChanged();
+    void descendingChanged();
+    void pageSizeChanged();
+    void countChanged();
+    void resultsChanged();
+    void busyChanged();
+    // 一次查询的结果已应用到模型
+    void queryFinished(int totalCount);
+
+private:
+    static constexpr size_t kNoRow = static_cast<size_t>(-1);
+    static constexpr int kDebounceMs = 150;
+
+    // 一次查询所需的全部条件（复制到后台线程）
+    struct QuerySpec {
+        ProductQuery query;
+        QString sortKey;
+        bool descending;
+    };
+
+    DataManager& m_dataManager;
+    std::mutex m_catalogMutex;
+    QThreadPool m_queryPool;
+    QTimer m_debounce;
+    std::atomic<uint64_t> m_generation{0};
+    bool m_busy = false;
+
+    QString m_keyword;
+    QString m_category = "全部";
+    double m_minPrice = -1.0;
+    double m_maxPrice = -1.0;
+    bool m_inStockOnly = false;
+    QString m_sortKey;
+    bool m_descending = false;
+    int m_pageSize = 60;
+
+    std::vector<size_t> m_matches; // 命中商品的下标，按展示顺序
+    size_t m_loaded = 0;           // 已暴露给视图的行数
+    QVariantMap m_categoryCounts;
+    int m_inStockCount = 0;
+    int m_outOfStockCount = 0;
+
+    QuerySpec currentSpec() const {
+        QuerySpec spec;
+        spec.query.keyword = m_keyword.toStdString();
+        spec.query.category = m_category.toStdString();
+        spec.query.minPrice = m_minPrice;
+        spec.query.maxPrice = m_maxPrice;
+        spec.query.inStockOnly = m_inStockOnly;
+        spec.sortKey = m_sortKey;
+        spec.descending = m_descending;
+        return spec;
+    }
+
+    /**
+     * @brief 执行查询，调用方须持有 m_catalogMutex
+     *
+     * 关键词不为空且未指定排序字段时按相关度排序，否则由有序索引按排序字段排列（同值按下标升序）
+     */
+    ProductQueryResult runQuery(const QuerySpec& spec) {
+        ProductQueryResult result = m_dataManager.queryProducts(spec.query);
+
+        if (!spec.sortKey.isEmpty()) {
+            m_dataManager.sortProducts(result.matches, toSortKey(spec.sortKey), spec.descending);
+        }
+        return result;
+    }
+
+    /**
+     * @brief 在主线程应用查询结果
+     *
+     * 新旧结果按行比较，只对变化的部分发出增删通知，保留下来的行其委托不会重建；
+     * 已暴露的行数保持不变（至少一批），用户滚动过的位置不会因筛选被截断
+     */
+    void applyResult(ProductQueryResult result, bool catalogChanged) {
+        const size_t newLoaded = std::min(result.matches.size(), std::max(m_loaded, static_cast<size_t>(m_pageSize)));
+        applyDiff(std::move(result.matches), newLoaded);
+        if (catalogChanged && m_loaded > 0) {
+            emit dataChanged(index(0), index(static_cast<int>(m_loaded) - 1));
+        }
+
+        m_categoryCounts.clear();
+        for (const auto& item : result.categoryCounts) {
+            m_categoryCounts[QString::fromStdString(item.category)] = item.count;
+        }
+        m_inStockCount = result.inStockCount;
+        m_outOfStockCount = result.outOfStockCount;
+
+        emit countChanged();
+        emit resultsChanged();
+    }
+
+    void setBusy(bool value) {
+        if (m_busy == value) return;
+        m_busy = value;
+        emit busyChanged();
+    }
+
+    /**
+     * @brief 把已暴露的行从旧结果改为新结果的前 newLoaded 行
+     *
+     * 1. 两边都有的行按在新结果中的位置求最长递增子序列，子序列中的行原地保留
+     * 2. 其余旧行从后往前成段删除（包括只是换了位置的行）
+     * 3. 新结果中缺少的行按位置成段插入
+     * 每一步之后 m_matches 的前 m_loaded 项都与视图看到的行一致，代价 O(k log k)，k 为已暴露的行数
+     */
+    void applyDiff(std::vector<size_t> newMatches, size_t newLoaded) {
+        const size_t oldLoaded = m_loaded;
+        m_matches.resize(oldLoaded); // 未暴露的旧行视图看不到，直接丢弃
+
+        FlatHashMap<size_t, size_t> newRowOf;
+        newRowOf.reserve(newLoaded);
+        for (size_t row = 0; row < newLoaded; row++) {
+            newRowOf.insert(newMatches[row], row);
+        }
+
+        std::vector<size_t> target(oldLoaded, kNoRow); // 旧行在新结果中的行号
+        for (size_t row = 0; row < oldLoaded; row++) {
+            if (const size_t* newRow = newRowOf.find(m_matches[row])) {
+                target[row] = *newRow;
+            }
+        }
+
+        // 最长递增子序列（耐心排序），tails[k] 为长度 k+1 的子序列中结尾最小的旧行
+        std::vector<size_t> tails;
+        std::vector<size_t> previous(oldLoaded, kNoRow);
+        for (size_t row = 0; row < oldLoaded; row++) {
+            if (target[row] == kNoRow) {
+                continue;
+            }
+            auto it = std::lower_bound(tails.begin(), tails.end(), target[row],
+                                       [&](size_t tail, size_t value) { return target[tail] < value; });
+            if (it != tails.begin()) {
+                previous[row] = *(it - 1);
+            }
+            if (it == tails.end()) {
+                tails.push_back(row);
+            } else {
+                *it = row;
+            }
+        }
+        std::vector<char> keep(oldLoaded, 0);
+        for (size_t row = tails.empty() ? kNoRow : tails.back(); row != kNoRow; row = previous[row]) {
+            keep[row] = 1;
+        }
+
+        for (size_t end = oldLoaded; end > 0;) {
+            if (keep[end - 1]) {
+                end--;
+                continue;
+            }
+            size_t first = end - 1;
+            while (first > 0 && !keep[first - 1]) {
+                first--;
+            }
+            beginRemoveRows(QModelIndex(), static_cast<int>(first), static_cast<int>(end) - 1);
+            m_matches.erase(m_matches.begin() + static_cast<std::ptrdiff_t>(first),
+                            m_matches.begin() + static_cast<std::ptrdiff_t>(end));
+            m_loaded -= end - first;
+            endRemoveRows();
+            end = first;
+        }
+
+        // 保留下来的行是新结果的子序列，逐段补齐其间缺少的行
+        size_t row = 0;
+        for (size_t next = 0; next < newLoaded;) {
+            if (row < m_loaded && m_matches[row] == newMatches[next]) {
+                row++;
+                next++;
+                continue;
+            }
+            size_t end = next;
+            while (end < newLoaded && !(row < m_loaded && m_matches[row] == newMatches[end])) {
+                end++;
+            }
+            beginInsertRows(QModelIndex(), static_cast<int>(row), static_cast<int>(row + end - next) - 1);
+            m_matches.insert(m_matches.begin() + static_cast<std::ptrdiff_t>(row),
+                             newMatches.begin() + static_cast<std::ptrdiff_t>(next),
+                             newMatches.begin() + static_cast<std::ptrdiff_t>(end));
+            m_loaded += end - next;
+            endInsertRows();
+            row += end - next;
+            next = end;
+        }
+
+        m_matches = std::move(newMatches);
+    }
+};
+
+/**
+ * @brief 当前用户的购物车列表模型
+ *
+ * - 打开购物车时从 DataManager 读取一次（load），之后的增删改直接修改同一个 DataManager
+ *   并立即提交保存，不再每次重新读取 JSON 文件
+ * - 行按商品ID升序排列（与 UserData::shoppingCart 一致），按商品ID二分定位
+ * - 总价与总数量随每次修改按差值更新，O(1)；金额按分（整数）累计，反复加减不会产生浮点误差
+ * - 结算会扣减商品库存：在主线程持有商品列表模型的 lockCatalog() 完成内存中的部分，
+ *   等待落盘在后台线程进行，完成后回到主线程确认（落盘失败时回滚）、刷新商品列表并发出 checkoutFinished
+ */
+class CartListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(QString username READ username NOTIFY usernameChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int totalQuantity READ totalQuantity NOTIFY totalsChanged)
+    Q_PROPERTY(double totalPrice READ totalPrice NOTIFY totalsChanged)
+    Q_PROPERTY(bool checkingOut READ checkingOut NOTIFY checkingOutChanged)
+
+public:
+    enum Roles {
+        ProductIdRole = Qt::UserRole + 1,
+        NameRole,
+        QuantityRole,
+        UnitPriceRole,
+        SubtotalRole,
+        DisplayUnitPriceRole,
+        DisplaySubtotalRole
+    };
+
+    CartListModel(DataManager& dataManager, ProductListModel* catalog, QObject* parent = nullptr)
+        : QAbstractListModel(parent), m_dataManager(dataManager), m_catalog(catalog) {
+        m_checkoutPool.setMaxThreadCount(1);
+    }
+
+    // 等待中的结算引用 m_dataManager，析构前须等待其结束
+    ~CartListModel() override {
+        m_checkoutPool.waitForDone();
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(m_items.size());
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (index.row() < 0 || static_cast<size_t>(index.row()) >= m_items.size()) {
+            return QVariant();
+        }
+        const CartItemDetails& item = m_items[static_cast<size_t>(index.row())];
+
+        switch (role) {
+            case ProductIdRole: return item.productId;
+            case NameRole: return QString::fromStdString(item.name);
+            case QuantityRole: return item.quantity;
+            case UnitPriceRole: return item.unitPrice;
+            case SubtotalRole: return item.subtotal;
+            case DisplayUnitPriceRole: return formatPrice(item.unitPrice);
+            case DisplaySubtotalRole: return formatPrice(item.subtotal);
+            default: return QVariant();
+        }
+    }
+
+    QHash<int, QByteArray> roleNames() const override {
+        return {
+            {ProductIdRole, "productId"},
+            {NameRole, "name"},
+            {QuantityRole, "quantity"},
+            {UnitPriceRole, "unitPrice"},
+            {SubtotalRole, "subtotal"},
+            {DisplayUnitPriceRole, "displayUnitPrice"},
+            {DisplaySubtotalRole, "displaySubtotal"}
+        };
+    }
+
+    QString username() const { return m_username; }
+    int count() const { return static_cast<int>(m_items.size()); }
+    int totalQuantity() const { return m_totalQuantity; }
+    double totalPrice() const { return static_cast<double>(m_totalCents) / 100.0; }
+    bool checkingOut() const { return m_checkingOut; }
+
+    // 读取用户的购物车；用户名为空时清空列表
+    // 先从文件重新加载用户数据：商品页等处通过临时 DataManager 修改购物车并保存，内存中的副本可能已过期
+    Q_INVOKABLE void load(const QString& username) {
+        if (!username.isEmpty()) {
+            m_dataManager.loadUsersFromJson();
+        }
+        if (m_username != username) {
+            m_username = username;
+            emit usernameChanged();
+        }
+        resetRows();
+    }
+
+    // 加入购物车，已有的商品累加数量
+    Q_INVOKABLE bool add(int productId, int quantity) {
+        if (quantity <= 0) {
+            return false;
+        }
+        const size_t row = rowOf(productId);
+        const int current = contains(row, productId) ? m_items[row].quantity : 0;
+        return setQuantity(productId, current + quantity);
+    }
+
+    // 设置数量，不大于 0 时移除
+    Q_INVOKABLE bool setQuantity(int productId, int quantity) {
+        if (quantity <= 0) {
+            return remove(productId);
+        }
+        if (m_username.isEmpty() ||
+            !m_dataManager.updateCartQuantity(m_username.toStdString(), productId, quantity)) {
+            return false;
+        }
+
+        const size_t row = rowOf(productId);
+        if (contains(row, productId)) {
+            CartItemDetails& item = m_items[row];
+            applyTotals(item, quantity - item.quantity);
+            item.quantity = quantity;
+            item.subtotal = item.unitPrice * static_cast<double>(quantity);
+            const QModelIndex changed = index(static_cast<int>(row));
+            emit dataChanged(changed, changed, {QuantityRole, SubtotalRole, DisplaySubtotalRole});
+        } else {
+            const ProductData* product = m_dataManager.findProduct(productId);
+            CartItemDetails item{};
+            item.productId = productId;
+            item.name = product ? std::string(product->name) : "未知商品";
+            item.unitPrice = product ? product->price : 0.0;
+            item.quantity = quantity;
+            item.subtotal = item.unitPrice * static_cast<double>(quantity);
+
+            beginInsertRows(QModelIndex(), static_cast<int>(row), static_cast<int>(row));
+            m_items.insert(m_items.begin() + static_cast<std::ptrdiff_t>(row), item);
+            endInsertRows();
+            applyTotals(m_items[row], quantity);
+            emit countChanged();
+        }
+
+        persist();
+        emit totalsChanged();
+        return true;
+    }
+
+    Q_INVOKABLE bool remove(int productId) {
+        const size_t row = rowOf(productId);
+        if (m_username.isEmpty() || !contains(row, productId) ||
+            !m_dataManager.removeFromCart(m_username.toStdString(), productId)) {
+            return false;
+        }
+
+        applyTotals(m_items[row], -m_items[row].quantity);
+        beginRemoveRows(QModelIndex(), static_cast<int>(row), static_cast<int>(row));
+        m_items.erase(m_items.begin() + static_cast<std::ptrdiff_t>(row));
+        endRemoveRows();
+
+        persist();
+        emit countChanged();
+        emit totalsChanged();
+        return true;
+    }
+
+    // 清空购物车，只提交一次保存
+    Q_INVOKABLE bool clear() {
+        if (m_username.isEmpty() || m_items.empty()) {
+            return false;
+        }
+        const std::string username = m_username.toStdString();
+        for (const auto& item : m_items) {
+            m_dataManager.removeFromCart(username, item.productId);
+        }
+
+        beginResetModel();
+        m_items.clear();
+        m_totalCents = 0;
+        m_totalQuantity = 0;
+        endResetModel();
+
+        persist();
+        emit countChanged();
+        emit totalsChanged();
+        return true;
+    }
+
+    /**
+     * @brief 结算购物车：库存全部足够时扣减库存并移出已购商品，否则购物车与库存保持不变
+     * @return 已开始等待落盘返回 true；未登录、库存不足等立即失败的情况返回 false
+     *
+     * 无论成功与否，结果都通过 checkoutFinished 通知
+     */
+    Q_INVOKABLE bool checkout() {
+        CheckoutResult result;
+        if (m_username.isEmpty()) {
+            result.message = "未登录";
+            emit checkoutFinished(toOutcome(false, result));
+            return false;
+        }
+        if (m_checkingOut) {
+            result.message = "正在结算中";
+            emit checkoutFinished(toOutcome(false, result));
+            return false;
+        }
+
+        CheckoutTicket ticket;
+        {
+            auto lock = m_catalog->lockCatalog();
+            ticket = m_dataManager.beginCheckout(m_username.toStdString(), result);
+        }
+        if (!ticket) {
+            emit checkoutFinished(toOutcome(false, result));
+            return false;
+        }
+
+        // 库存与购物车已在内存中变化，落盘确认之前就让视图反映出来
+        setCheckingOut(true);
+        resetRows();
+        m_catalog->refresh(true);
+
+        m_checkoutPool.start([this, ticket, result]() {
+            const bool durable = m_dataManager.waitForCheckout(ticket);
+            QMetaObject::invokeMethod(this, [this, ticket, result, durable]() mutable {
+                bool success;
+                {
+                    auto lock = m_catalog->lockCatalog();
+                    success = m_dataManager.endCheckout(ticket, durable, result);
+                }
+                if (!success) {
+                    resetRows(); // 已回滚：购物车与库存恢复原样
+                    m_catalog->refresh(true);
+                }
+                setCheckingOut(false);
+                emit checkoutFinished(toOutcome(success, result));
+            }, Qt::QueuedConnection);
+        });
+        return true;
+    }
+
+signals:
+    void usernameChanged();
+    void countChanged();
+    void totalsChanged();
+    void checkingOutChanged();
+    // 一次结算完成：{success, message, totalPrice, totalQuantity, failedProductId, availableStock}
+    void checkoutFinished(const QVariantMap& outcome);
+
+private:
+    DataManager& m_dataManager;
+    ProductListModel* m_catalog;
+    QString m_username;
+    std::vector<CartItemDetails> m_items; // 按商品ID升序
+    long long m_totalCents = 0;
+    int m_totalQuantity = 0;
+    QThreadPool m_checkoutPool;
+    bool m_checkingOut = false;
+
+    // 按内存中的购物车重建全部行
+    void resetRows() {
+        beginResetModel();
+        m_items.clear();
+        m_totalCents = 0;
+        m_totalQuantity = 0;
+        if (!m_username.isEmpty()) {
+            double totalPrice = 0.0;
+            m_items = m_dataManager.getShoppingCartDetails(m_username.toStdString(), totalPrice, m_totalQuantity);
+            for (const auto& item : m_items) {
+                m_totalCents += toCents(item.unitPrice) * item.quantity;
+            }
+        }
+        endResetModel();
+        emit countChanged();
+        emit totalsChanged();
+    }
+
+    void setCheckingOut(bool value) {
+        if (m_checkingOut == value) return;
+        m_checkingOut = value;
+        emit checkingOutChanged();
+    }
+
+    static QVariantMap toOutcome(bool success, const CheckoutResult& result) {
+        QVariantMap outcome;
+        outcome["success"] = success;
+        outcome["message"] = QString::fromStdString(result.message);
+        outcome["totalPrice"] = result.totalPrice;
+        outcome["totalQuantity"] = result.totalQuantity;
+        outcome["failedProductId"] = result.failedProductId;
+        outcome["availableStock"] = result.availableStock;
+        return outcome;
+    }
+
+    static long long toCents(double price) {
+        return std::llround(price * 100.0);
+    }
+
+    static QString formatPrice(double value) {
+        return "¥" + QString::number(value, 'f', 2);
+    }
+
+    // 第一个商品ID不小于 productId 的行
+    size_t rowOf(int productId) const {
+        auto it = std::lower_bound(m_items.begin(), m_items.end(), productId,
+                                   [](const CartItemDetails& item, int id) { return item.productId < id; });
+        return static_cast<size_t>(it - m_items.begin());
+    }
+
+    bool contains(size_t row, int productId) const {
+        return row < m_items.size() && m_items[row].productId == productId;
+    }
+
+    void applyTotals(const CartItemDetails& item, int quantityDelta) {
+        m_totalQuantity += quantityDelta;
+        m_totalCents += toCents(item.unitPrice) * quantityDelta;
+    }
+
+    void persist() {
+        bool saved = m_dataManager.saveDirtyUsers();
+        qDebug() << "购物车修改 - 提交保存:" << (saved ? "成功" : "失败");
+    }
+};
+
 // DataManager 的 QML 包装器 - 增强版本，添加自动保存
 class DataManagerWrapper : public QObject {
     Q_OBJECT
+    Q_PROPERTY(ProductListModel* productModel READ productModel CONSTANT)
+    Q_PROPERTY(CartListModel* cartModel READ cartModel CONSTANT)
 
 public:
-    explicit DataManagerWrapper(QObject* parent = nullptr) : QObject(parent) {
+    explicit DataManagerWrapper(QObject* parent = nullptr)
+        : QObject(parent),
+          m_productModel(new ProductListModel(m_dataManager, this)),
+          m_cartModel(new CartListModel(m_dataManager, m_productModel, this)) {
         m_dataManager.loadUsersFromJson();
         m_dataManager.loadProductsFromJson();
     }
 
+    // 模型的后台查询与结算引用 m_dataManager，须在成员析构之前先等它们结束
+    ~DataManagerWrapper() override {
+        delete m_cartModel;
+        delete m_productModel;
+    }
+
+    // 商品浏览列表模型，查询条件通过模型属性设置
+    ProductListModel* productModel() const {
+        return m_productModel;
+    }
+
+    // 购物车列表模型，打开购物车页面时调用 cartModel.load(用户名)
+    CartListModel* cartModel() const {
+        return m_cartModel;
+    }
+
     Q_INVOKABLE QVariantList getProducts() {
         QVariantList productList;
-        auto products = m_dataManager.getProducts();
+        const auto& products = m_dataManager.getProducts();
+        productList.reserve(static_cast<qsizetype>(products.size()));
 
         for (const auto& product : products) {
-            QVariantMap productMap;
-            productMap["productId"] = product.productId;
-            productMap["name"] = QString::fromStdString(product.name);
-            productMap["price"] = product.price;
-            productMap["stock"] = product.stock;
-            productMap["category"] = QString::fromStdString(product.category);
-            productMap["avgRating"] = product.avgRating; // 使用修正后的字段名
-            productMap["reviewers"] = product.reviewers;
-            productList.append(productMap);
+            productList.append(productToVariant(product));
         }
 
         return productList;
@@ -346,29 +1124,49 @@ public:
 
     Q_INVOKABLE QVariantMap findProduct(int productId) {
         auto product = m_dataManager.findProduct(productId);
-        QVariantMap productMap;
-
-        if (product) {
-            productMap["productId"] = product->productId;
-            productMap["name"] = QString::fromStdString(product->name);
-            productMap["price"] = product->price;
-            productMap["stock"] = product->stock;
-            productMap["category"] = QString::fromStdString(product->category);
-            productMap["avgRating"] = product->avgRating;
-            productMap["reviewers"] = product->reviewers;
-        }
-
-        return productMap;
+        return product ? productToVariant(*product) : QVariantMap();
     }
 
     Q_INVOKABLE bool loadProductsFromJson() {
-        return m_dataManager.loadProductsFromJson();
+        bool success;
+        {
+            auto lock = m_productModel->lockCatalog();
+            success = m_dataManager.loadProductsFromJson();
+        }
+        m_productModel->refresh(true);
+        return success;
     }
 
     Q_INVOKABLE bool saveUsersToJson() {
         return m_dataManager.saveUsersToJson();
     }
 
+    // 增量保存：只写入有变化用户所在的分片
+    Q_INVOKABLE bool saveDirtyUsers() {
+        return m_dataManager.saveDirtyUsers();
+    }
+
+    // 等待后台写入完成，返回写入是否全部成功
+    Q_INVOKABLE bool flush() {
+        return m_dataManager.flush();
+    }
+
+    // 后台持久化指标：队列深度与写入耗时
+    Q_INVOKABLE QVariantMap getPersistenceMetrics() {
+        PersistenceMetrics metrics = m_dataManager.persistenceMetrics();
+        QVariantMap result;
+        result["queueDepth"] = static_cast<int>(metrics.queueDepth);
+        result["inFlight"] = static_cast<int>(metrics.inFlight);
+        result["submitted"] = static_cast<int>(metrics.submitted);
+        result["coalesced"] = static_cast<int>(metrics.coalesced);
+        result["completed"] = static_cast<int>(metrics.completed);
+        result["failed"] = static_cast<int>(metrics.failed);
+        result["lastWriteMs"] = metrics.lastWriteMs;
+        result["avgWriteMs"] = metrics.avgWriteMs;
+        result["maxWriteMs"] = metrics.maxWriteMs;
+        return result;
+    }
+
     // 新增：添加浏览历史的包装方法
     Q_INVOKABLE bool addViewHistory(const QString& username, int productId) {
         if (username.isEmpty()) {
@@ -378,8 +1176,8 @@ public:
         bool success = m_dataManager.addViewHistory(username.toStdString(), productId);
         
         if (success) {
-            // 立即保存用户数据
-            bool saved = m_dataManager.saveUsersToJson();
+            // 立即保存变化的用户数据
+            bool saved = m_dataManager.saveDirtyUsers();
             qDebug() << "DataManager 添加浏览历史 - 保存到文件:" << (saved ? "成功" : "失败");
         }
         
@@ -397,10 +1195,7 @@ public:
             return result;
         }
 
-        // 确保用户和商品数据已加载
-        m_dataManager.loadUsersFromJson();
-        m_dataManager.loadProductsFromJson();
-
+        // 用户与商品数据在构造时已加载；页面每次打开都会重新创建 DataManager，无需再读文件
         double totalPrice = 0.0;
         int totalQuantity = 0;
         auto details = m_dataManager.getShoppingCartDetails(username.toStdString(), totalPrice, totalQuantity);
@@ -424,11 +1219,11 @@ public:
 
     Q_INVOKABLE QStringList getCategories() {
         QStringList categories;
-        auto products = m_dataManager.getProducts();
+        const auto& products = m_dataManager.getProducts();
         QSet<QString> categorySet;
 
         for (const auto& product : products) {
-            categorySet.insert(QString::fromStdString(product.category));
+            categorySet.insert(product.category.toQString());
         }
 
         categories = QStringList(categorySet.begin(), categorySet.end());
@@ -436,20 +1231,100 @@ public:
         return categories;
     }
 
+    // 组合筛选：价格小于 0 表示不限；返回 {products, total, categoryCounts, inStockCount, outOfStockCount, minPrice, maxPrice}
+    Q_INVOKABLE QVariantMap queryProducts(const QString& keyword, const QString& category,
+                                          double minPrice = -1.0, double maxPrice = -1.0, bool inStockOnly = false) {
+        ProductQuery query;
+        query.keyword = keyword.toStdString();
+        query.category = category.toStdString();
+        query.minPrice = minPrice;
+        query.maxPrice = maxPrice;
+        query.inStockOnly = inStockOnly;
+
+        // 查询索引在第一次查询时建立，与模型的后台查询互斥
+        auto lock = m_productModel->lockCatalog();
+        ProductQueryResult queryResult = m_dataManager.queryProducts(query);
+        const auto& products = m_dataManager.getProducts();
+
+        QVariantList productList;
+        productList.reserve(static_cast<qsizetype>(queryResult.matches.size()));
+        for (size_t slot : queryResult.matches) {
+            productList.append(productToVariant(products[slot]));
+        }
+
+        QVariantMap categoryCounts;
+        for (const auto& item : queryResult.categoryCounts) {
+            categoryCounts[QString::fromStdString(item.category)] = item.count;
+        }
+
+        QVariantMap result;
+        result["products"] = productList;
+        result["total"] = static_cast<int>(queryResult.matches.size());
+        result["categoryCounts"] = categoryCounts;
+        result["inStockCount"] = queryResult.inStockCount;
+        result["outOfStockCount"] = queryResult.outOfStockCount;
+        result["minPrice"] = queryResult.minPrice;
+        result["maxPrice"] = queryResult.maxPrice;
+        return result;
+    }
+
+    // 范围 + 排序 + 分页查询：字段为 "price"/"avgRating"/"reviewers"/"stock"，上下限小于 0 表示不限
+    // 返回 {products, total}
+    Q_INVOKABLE QVariantMap queryProductPage(const QString& rangeKey, double minValue, double maxValue,
+                                             const QString& sortKey, bool descending, int offset, int limit) {
+        ProductRangeQuery query;
+        query.rangeKey = toSortKey(rangeKey);
+        query.minValue = minValue;
+        query.maxValue = maxValue;
+        query.sortKey = toSortKey(sortKey);
+        query.descending = descending;
+        query.offset = static_cast<size_t>(std::max(offset, 0));
+        query.limit = static_cast<size_t>(std::max(limit, 0));
+
+        auto lock = m_productModel->lockCatalog();
+        ProductPage page = m_dataManager.queryProductRange(query);
+        const auto& products = m_dataManager.getProducts();
+
+        QVariantList productList;
+        productList.reserve(static_cast<qsizetype>(page.matches.size()));
+        for (size_t slot : page.matches) {
+            productList.append(productToVariant(products[slot]));
+        }
+
+        QVariantMap result;
+        result["products"] = productList;
+        result["total"] = static_cast<int>(page.total);
+        return result;
+    }
+
+    // 搜索框输入补全：返回 [{text, isCategory, productCount}, ...]
+    Q_INVOKABLE QVariantList getCompletions(const QString& prefix, int limit = 8) {
+        QVariantList completionList;
+        if (limit <= 0) {
+            return completionList;
+        }
+
+        auto lock = m_productModel->lockCatalog();
+        auto completions = m_dataManager.completeProducts(prefix.toStdString(), static_cast<size_t>(limit));
+        for (const auto& completion : completions) {
+            QVariantMap completionMap;
+            completionMap["text"] = QString::fromStdString(completion.text);
+            completionMap["isCategory"] = completion.isCategory;
+            completionMap["productCount"] = completion.productCount;
+            completionList.append(completionMap);
+        }
+
+        return completionList;
+    }
+
     Q_INVOKABLE QVariantList searchProducts(const QString& keyword) {
         QVariantList productList;
-        auto products = m_dataManager.searchProducts(keyword.toStdString());
+        auto lock = m_productModel->lockCatalog();
+        const ProductResultSet products = m_dataManager.searchProducts(keyword.toStdString());
+        productList.reserve(static_cast<qsizetype>(products.size()));
 
         for (const auto& product : products) {
-            QVariantMap productMap;
-            productMap["productId"] = product.productId;
-            productMap["name"] = QString::fromStdString(product.name);
-            productMap["price"] = product.price;
-            productMap["stock"] = product.stock;
-            productMap["category"] = QString::fromStdString(product.category);
-            productMap["avgRating"] = product.avgRating;
-            productMap["reviewers"] = product.reviewers;
-            productList.append(productMap);
+            productList.append(productToVariant(product));
         }
 
         return productList;
@@ -457,29 +1332,46 @@ public:
 
     Q_INVOKABLE QVariantList filterByCategory(const QString& category) {
         QVariantList productList;
-        auto products = m_dataManager.filterByCategory(category.toStdString());
+        auto lock = m_productModel->lockCatalog();
+        const ProductResultSet products = m_dataManager.filterByCategory(category.toStdString());
+        productList.reserve(static_cast<qsizetype>(products.size()));
 
         for (const auto& product : products) {
-            QVariantMap productMap;
-            productMap["productId"] = product.productId;
-            productMap["name"] = QString::fromStdString(product.name);
-            productMap["price"] = product.price;
-            productMap["stock"] = product.stock;
-            productMap["category"] = QString::fromStdString(product.category);
-            productMap["avgRating"] = product.avgRating;
-            productMap["reviewers"] = product.reviewers;
-            productList.append(productMap);
+            productList.append(productToVariant(product));
         }
 
         return productList;
     }
 
     Q_INVOKABLE bool updateProductRating(int productId, int newRating, int oldRating = -1) {
-        return m_dataManager.updateProductRating(productId, newRating, oldRating);
+        bool success;
+        {
+            auto lock = m_productModel->lockCatalog();
+            success = m_dataManager.updateProductRating(productId, newRating, oldRating);
+        }
+        if (success) {
+            m_productModel->productChanged(productId);
+        }
+        return success;
     }
 
 private:
     DataManager m_dataManager;
+    ProductListModel* m_productModel;
+    CartListModel* m_cartModel;
+
+    // 商品列表各接口共用的字段映射
+    static QVariantMap productToVariant(const ProductData& product) {
+        QVariantMap productMap;
+        productMap["productId"] = product.productId;
+        productMap["name"] = product.name.toQString();
+        productMap["price"] = product.price;
+        productMap["stock"] = product.stock;
+        productMap["category"] = product.category.toQString();
+        productMap["avgRating"] = product.avgRating;
+        productMap["reviewers"] = product.reviewers;
+        return productMap;
+    }
 };
 
 // UserManager 的 QML 包装器 - 保持原有实现
@@ -499,6 +1391,20 @@ public:
         return result;
     }
 
+    // 分页获取用户（按用户ID升序），只转换当前页
+    Q_INVOKABLE QVariantList getUsers(int offset, int limit) {
+        return m_userManager.getUsers(offset, limit);
+    }
+
+    Q_INVOKABLE int getUserCount() {
+        return m_userManager.getUserCount();
+    }
+
+    // 用户在列表中的位置，不存在返回 -1
+    Q_INVOKABLE int getUserIndex(int userId) {
+        return m_userManager.getUserIndex(userId);
+    }
+
     // 添加用户
     Q_INVOKABLE bool addUser(const QString& username, const QString& password, bool isAdmin = false) {
         bool result = m_userManager.addUser(username, password, isAdmin);
@@ -517,6 +1423,9 @@ public:
     Q_INVOKABLE bool deleteUser(int userId) {
         bool result = m_userManager.deleteUser(userId);
         if (result) {
+            // 被删除用户的会话随之失效
+            ::revokeUserSessions(userId);
+            ::saveAppState();
             qDebug() << "UserManagerWrapper: 用户删除成功，发射信号";
             emit userDeleted(userId);
             emit dataChanged();
@@ -531,6 +1440,9 @@ public:
     Q_INVOKABLE bool updateUser(int userId, const QString& username, bool isAdmin) {
         bool result = m_userManager.updateUser(userId, username, isAdmin);
         if (result) {
+            // 会话中缓存的管理员身份与用户保持一致
+            ::updateUserSessions(userId, isAdmin);
+            ::saveAppState();
             qDebug() << "UserManagerWrapper: 用户更新成功，发射信号";
             emit userUpdated(userId);
             emit dataChanged();
@@ -581,6 +1493,7 @@ public:
     Q_INVOKABLE bool loadFromFile() {
         bool result = m_userManager.loadFromFile();
         if (result) {
+            syncSessions();
             qDebug() << "UserManagerWrapper: 数据加载成功";
             emit dataChanged();
         }
@@ -593,6 +1506,7 @@ public:
     // 刷新数据
     Q_INVOKABLE void refreshData() {
         m_userManager.refreshData();
+        syncSessions();
         qDebug() << "UserManagerWrapper: 数据已刷新";
         emit dataChanged();
     }
@@ -607,17 +1521,39 @@ signals:
 
 private:
     UserManager m_userManager;
+
+    // 用户数据重新加载后，撤销已不存在用户的会话，并按当前权限更新其余会话
+    void syncSessions() {
+        ::refreshSessions([this](int userId, bool& isAdmin) {
+            const QVariantMap user = m_userManager.getUserById(userId);
+            if (user.isEmpty()) {
+                return false;
+            }
+            isAdmin = user.value("isAdmin").toBool();
+            return true;
+        });
+        ::saveAppState();
+    }
 };
 
 int main(int argc, char* argv[]) {
     QGuiApplication app(argc, argv);
 
+    // 退出前等待后台持久化线程写完所有已提交的数据
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, [] {
+        PersistenceWorker::instance().flush();
+    });
+
     // 初始化应用程序状态
     initializeApp();
 
     // 注册类型到 QML
     qmlRegisterType<StateManagerWrapper>("StateManager", 1, 0, "StateManager");
     qmlRegisterType<DataManagerWrapper>("DataManager", 1, 0, "DataManager");
+    qmlRegisterUncreatableType<ProductListModel>("DataManager", 1, 0, "ProductListModel",
+                                                 "ProductListModel 由 DataManager.productModel 提供");
+    qmlRegisterUncreatableType<CartListModel>("DataManager", 1, 0, "CartListModel",
+                                              "CartListModel 由 DataManager.cartModel 提供");
     qmlRegisterType<UserManagerWrapper>("UserManager", 1, 0, "UserManager");
     qmlRegisterType<RecommenderWrapper>("Recommender", 1, 0, "Recommender");
 